@@ -0,0 +1,57 @@
+#include "analysisjob.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+AnalysisJob::AnalysisJob(QObject *parent) : QObject(parent) {
+    connect(&m_watcher, &QFutureWatcher<AnalysisResult>::progressValueChanged, this,
+            [this](int value) { emit progressChanged(value, m_watcher.progressMaximum()); });
+    connect(&m_watcher, &QFutureWatcher<AnalysisResult>::resultReadyAt, this,
+            [this](int index) { emit resultReady(m_watcher.resultAt(index)); });
+    connect(&m_watcher, &QFutureWatcher<AnalysisResult>::finished, this, [this]() {
+        emit finished(m_watcher.isCanceled());
+    });
+}
+
+AnalysisJob::~AnalysisJob() {
+    m_cancelFlag->store(true);
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+bool AnalysisJob::start(const QString &name, const QList<AnalysisTarget> &targets, AnalysisFn analyze) {
+    if (isRunning()) {
+        return false;
+    }
+    m_name = name;
+    m_cancelFlag->store(false);
+    emit progressChanged(0, targets.size());
+    m_watcher.setFuture(QtConcurrent::mapped(targets, [fn = std::move(analyze)](const AnalysisTarget &target) {
+        AnalysisResult result = fn(target);
+        result.row = target.row;
+        return result;
+    }));
+    return true;
+}
+
+void AnalysisJob::cancel() {
+    if (isRunning()) {
+        m_cancelFlag->store(true);
+        m_watcher.cancel();
+    }
+}
+
+bool AnalysisJob::isRunning() const {
+    return m_watcher.isRunning();
+}
+
+QString AnalysisJob::name() const {
+    return m_name;
+}
+
+QList<AnalysisResult> AnalysisJob::results() const {
+    return m_watcher.future().results();
+}
+
+std::shared_ptr<const std::atomic_bool> AnalysisJob::cancelFlag() const {
+    return m_cancelFlag;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+struct AnalysisTarget {
+    // Position in the list passed to start(); results carry it back, since
+    // several cards can share an id.
+    int row = -1;
+    QString audioPath;
+};
+
+// values maps a track field to the suggested value; "<field>_confidence"
+// entries carry the matching score in [0, 1].
+struct AnalysisResult {
+    int row = -1;
+    QVariantMap values;
+    QString error;
+};
+
+using AnalysisFn = std::function<AnalysisResult(const AnalysisTarget &target)>;
+
+class AnalysisJob : public QObject {
+    Q_OBJECT
+
+public:
+    explicit AnalysisJob(QObject *parent = nullptr);
+    ~AnalysisJob() override;
+
+    bool start(const QString &name, const QList<AnalysisTarget> &targets, AnalysisFn analyze);
+    void cancel();
+    bool isRunning() const;
+    QString name() const;
+    // Every result of the last run, in target order; kept until the next start().
+    QList<AnalysisResult> results() const;
+    // Raised by cancel() so long-running items can stop part way; reset by start().
+    std::shared_ptr<const std::atomic_bool> cancelFlag() const;
+
+signals:
+    void progressChanged(int done, int total);
+    void resultReady(const AnalysisResult &result);
+    void finished(bool canceled);
+
+private:
+    QFutureWatcher<AnalysisResult> m_watcher;
+    QString m_name;
+    std::shared_ptr<std::atomic_bool> m_cancelFlag = std::make_shared<std::atomic_bool>(false);
+};
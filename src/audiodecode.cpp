@@ -0,0 +1,253 @@
+#include "audiodecode.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QUrl>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int kDecodeStallTimeoutMs = 30000;
+
+float sampleAt(const QAudioBuffer &buffer, qsizetype index) {
+    switch (buffer.format().sampleFormat()) {
+    case QAudioFormat::UInt8:
+        return (static_cast<float>(buffer.constData<quint8>()[index]) - 128.0f) / 128.0f;
+    case QAudioFormat::Int16:
+        return static_cast<float>(buffer.constData<qint16>()[index]) / 32768.0f;
+    case QAudioFormat::Int32:
+        return static_cast<float>(buffer.constData<qint32>()[index]) / 2147483648.0f;
+    case QAudioFormat::Float:
+        return buffer.constData<float>()[index];
+    default:
+        return 0.0f;
+    }
+}
+
+// Converts whatever the backend hands out into the requested layout. Most
+// backends honour the requested format, so the resampler is a fallback only.
+class ChunkConverter {
+public:
+    ChunkConverter(int targetRate, int targetChannels)
+        : m_targetRate(targetRate), m_targetChannels(std::max(1, targetChannels)) {}
+
+    const QVector<float> &convert(const QAudioBuffer &buffer) {
+        const QAudioFormat format = buffer.format();
+        const int srcChannels = std::max(1, format.channelCount());
+        const qsizetype frames = buffer.frameCount();
+
+        m_mixed.resize(frames * m_targetChannels);
+        for (qsizetype f = 0; f < frames; ++f) {
+            const qsizetype base = f * srcChannels;
+            if (m_targetChannels == 1) {
+                float sum = 0.0f;
+                for (int c = 0; c < srcChannels; ++c) {
+                    sum += sampleAt(buffer, base + c);
+                }
+                m_mixed[f] = sum / static_cast<float>(srcChannels);
+            } else {
+                for (int c = 0; c < m_targetChannels; ++c) {
+                    m_mixed[f * m_targetChannels + c] = sampleAt(buffer, base + std::min(c, srcChannels - 1));
+                }
+            }
+        }
+
+        const int srcRate = format.sampleRate();
+        if (m_targetRate <= 0 || srcRate <= 0 || srcRate == m_targetRate) {
+            return m_mixed;
+        }
+        return resample(srcRate, frames);
+    }
+
+    int outputRate(const QAudioFormat &format) const {
+        return m_targetRate > 0 ? m_targetRate : format.sampleRate();
+    }
+
+    int outputChannels() const { return m_targetChannels; }
+
+private:
+    const QVector<float> &resample(int srcRate, qsizetype frames) {
+        const double step = static_cast<double>(srcRate) / m_targetRate;
+        if (m_last.size() != m_targetChannels) {
+            m_last = QVector<float>(m_targetChannels, 0.0f);
+        }
+        m_resampled.clear();
+        // m_position is relative to the previous chunk's last frame (index -1).
+        while (m_position < static_cast<double>(frames) - 1.0) {
+            const qsizetype i = static_cast<qsizetype>(std::floor(m_position));
+            const float frac = static_cast<float>(m_position - std::floor(m_position));
+            for (int c = 0; c < m_targetChannels; ++c) {
+                const float a = i < 0 ? m_last[c] : m_mixed[i * m_targetChannels + c];
+                const float b = m_mixed[(i + 1) * m_targetChannels + c];
+                m_resampled.append(a + (b - a) * frac);
+            }
+            m_position += step;
+        }
+        m_position -= static_cast<double>(frames);
+        if (frames > 0) {
+            for (int c = 0; c < m_targetChannels; ++c) {
+                m_last[c] = m_mixed[(frames - 1) * m_targetChannels + c];
+            }
+        }
+        return m_resampled;
+    }
+
+    int m_targetRate = 0;
+    int m_targetChannels = 1;
+    double m_position = 0.0;
+    QVector<float> m_last;
+    QVector<float> m_mixed;
+    QVector<float> m_resampled;
+};
+}
+
+bool decodeAudioStream(const QString &path, const AudioDecodeOptions &options, const AudioChunkFn &onChunk,
+                       QString *error) {
+    if (!QFileInfo::exists(path)) {
+        if (error) {
+            *error = QStringLiteral("File not found");
+        }
+        return false;
+    }
+
+    QAudioDecoder decoder;
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setChannelCount(std::max(1, options.channelCount));
+    if (options.sampleRate > 0) {
+        format.setSampleRate(options.sampleRate);
+    }
+    decoder.setAudioFormat(format);
+    decoder.setSource(QUrl::fromLocalFile(path));
+
+    ChunkConverter converter(options.sampleRate, options.channelCount);
+    QEventLoop loop;
+    QTimer stallTimer;
+    stallTimer.setSingleShot(true);
+    stallTimer.setInterval(kDecodeStallTimeoutMs);
+
+    bool stopped = false;
+    bool failed = false;
+    QString message;
+    qint64 emittedFrames = 0;
+
+    QObject::connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        while (!stopped && decoder.bufferAvailable()) {
+            const QAudioBuffer buffer = decoder.read();
+            if (!buffer.isValid() || buffer.frameCount() <= 0) {
+                continue;
+            }
+            const QVector<float> &samples = converter.convert(buffer);
+            AudioStreamInfo info;
+            info.sampleRate = converter.outputRate(buffer.format());
+            info.channelCount = converter.outputChannels();
+            info.sourceChannelCount = buffer.format().channelCount();
+            qsizetype frames = samples.size() / info.channelCount;
+            if (options.maxDurationMs > 0 && info.sampleRate > 0) {
+                const qint64 limit = options.maxDurationMs * info.sampleRate / 1000;
+                frames = std::min<qsizetype>(frames, std::max<qint64>(0, limit - emittedFrames));
+            }
+            if (frames > 0 && !onChunk(samples.constData(), frames, info)) {
+                stopped = true;
+            }
+            emittedFrames += frames;
+            if (options.maxDurationMs > 0 && info.sampleRate > 0 &&
+                emittedFrames * 1000 >= options.maxDurationMs * info.sampleRate) {
+                stopped = true;
+            }
+        }
+        if (stopped) {
+            decoder.stop();
+            loop.quit();
+        }
+        // Restarted after the callbacks so a consumer that throttles itself
+        // inside onChunk is not mistaken for a stuck decoder.
+        stallTimer.start();
+    });
+    QObject::connect(&decoder, &QAudioDecoder::finished, &loop, &QEventLoop::quit);
+    QObject::connect(&decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), &loop,
+                     [&](QAudioDecoder::Error) {
+                         failed = true;
+                         message = decoder.errorString();
+                         loop.quit();
+                     });
+    QObject::connect(&stallTimer, &QTimer::timeout, &loop, [&]() {
+        failed = true;
+        message = QStringLiteral("Decoder stalled");
+        decoder.stop();
+        loop.quit();
+    });
+
+    decoder.start();
+    stallTimer.start();
+    loop.exec();
+    stallTimer.stop();
+
+    if (failed && !stopped) {
+        if (error) {
+            *error = message.isEmpty() ? QStringLiteral("Decoding failed") : message;
+        }
+        return false;
+    }
+    if (emittedFrames == 0 && !stopped) {
+        if (error) {
+            *error = QStringLiteral("No audio decoded");
+        }
+        return false;
+    }
+    return true;
+}
+
+bool decodeAudioFile(const QString &path, const AudioDecodeOptions &options, QVector<float> *samples,
+                     AudioStreamInfo *info, QString *error) {
+    samples->clear();
+    AudioStreamInfo streamInfo;
+    const bool ok = decodeAudioStream(
+        path, options,
+        [&](const float *data, qsizetype frames, const AudioStreamInfo &chunkInfo) {
+            streamInfo = chunkInfo;
+            samples->append(data, frames * chunkInfo.channelCount);
+            return true;
+        },
+        error);
+    if (info) {
+        *info = streamInfo;
+    }
+    return ok;
+}
+
+AudioFileStamp audioFileStamp(const QString &path) {
+    const QFileInfo info(path);
+    if (!info.exists()) {
+        return {};
+    }
+    return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+}
+
+QString audioCacheKey(const QString &path) {
+    const QFileInfo info(path);
+    const QString identity = QStringLiteral("%1|%2|%3")
+                                 .arg(info.absoluteFilePath())
+                                 .arg(info.lastModified().toMSecsSinceEpoch())
+                                 .arg(info.size());
+    return QString::fromLatin1(
+        QCryptographicHash::hash(identity.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+QString audioCacheFilePath(const QString &kind, const QString &path, const QString &suffix) {
+    const QString file = audioCacheLookupPath(kind, path, suffix);
+    QDir().mkpath(QFileInfo(file).absolutePath());
+    return file;
+}
+
+QString audioCacheLookupPath(const QString &kind, const QString &path, const QString &suffix) {
+    const QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return QDir(QDir(root).filePath(kind)).filePath(audioCacheKey(path) + suffix);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+struct AudioDecodeOptions {
+    int sampleRate = 0;
+    int channelCount = 1;
+    qint64 maxDurationMs = 0;
+};
+
+struct AudioStreamInfo {
+    int sampleRate = 0;
+    int channelCount = 0;
+    int sourceChannelCount = 0;
+};
+
+// Receives interleaved float frames at the requested rate/channel layout.
+// Returning false stops decoding early without reporting an error.
+using AudioChunkFn = std::function<bool(const float *samples, qsizetype frames, const AudioStreamInfo &info)>;
+
+bool decodeAudioStream(const QString &path, const AudioDecodeOptions &options, const AudioChunkFn &onChunk,
+                       QString *error = nullptr);
+bool decodeAudioFile(const QString &path, const AudioDecodeOptions &options, QVector<float> *samples,
+                     AudioStreamInfo *info = nullptr, QString *error = nullptr);
+
+// Size and modification time of a file, to notice when it is replaced.
+struct AudioFileStamp {
+    qint64 size = -1;
+    qint64 modifiedMs = -1;
+
+    bool operator==(const AudioFileStamp &other) const {
+        return size == other.size && modifiedMs == other.modifiedMs;
+    }
+    bool operator!=(const AudioFileStamp &other) const { return !(*this == other); }
+};
+
+AudioFileStamp audioFileStamp(const QString &path);
+QString audioCacheKey(const QString &path);
+QString audioCacheFilePath(const QString &kind, const QString &path, const QString &suffix);
+// The same path without creating the cache folder, for read-only lookups.
+QString audioCacheLookupPath(const QString &kind, const QString &path, const QString &suffix);
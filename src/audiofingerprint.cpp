@@ -0,0 +1,258 @@
+#include "audiofingerprint.h"
+
+#include "audiodecode.h"
+#include "fft.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+constexpr int kFingerprintSampleRate = 5512;
+constexpr qint64 kMaxFingerprintMs = 120000;
+constexpr int kFrameSize = 2048;
+constexpr int kHopSize = 256;
+constexpr int kBandCount = 33;
+constexpr double kMinBandHz = 300.0;
+constexpr double kMaxBandHz = 2000.0;
+constexpr quint32 kFingerprintFileMagic = 0x46505231;
+
+constexpr int kIndexStride = 4;
+constexpr int kIndexFrames = 1300;
+constexpr int kQueryFrames = 1300;
+constexpr int kMaxPostings = 200;
+constexpr int kMinVotes = 3;
+constexpr int kMinOverlapFrames = 100;
+
+struct Posting {
+    int track;
+    int frame;
+};
+
+using FingerprintIndex = QHash<quint32, QVector<Posting>>;
+
+bool readFingerprintFile(const QString &fileName, QVector<quint32> *fingerprint) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    in >> magic;
+    if (magic != kFingerprintFileMagic) {
+        return false;
+    }
+    in >> *fingerprint;
+    return in.status() == QDataStream::Ok && !fingerprint->isEmpty();
+}
+
+void writeFingerprintFile(const QString &fileName, const QVector<quint32> &fingerprint) {
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << kFingerprintFileMagic << fingerprint;
+    file.commit();
+}
+
+FingerprintIndex buildIndex(const QVector<QVector<quint32>> &fingerprints) {
+    FingerprintIndex index;
+    for (int track = 0; track < fingerprints.size(); ++track) {
+        const QVector<quint32> &fp = fingerprints[track];
+        const int frames = std::min<int>(fp.size(), kIndexFrames);
+        for (int frame = 0; frame < frames; frame += kIndexStride) {
+            const quint32 value = fp[frame];
+            if (value == 0 || value == 0xffffffffu) {
+                continue;
+            }
+            index[value].append({track, frame});
+        }
+    }
+    // Values shared by hundreds of tracks (silence, hum) carry no identity.
+    for (auto it = index.begin(); it != index.end();) {
+        it = it.value().size() > kMaxPostings ? index.erase(it) : std::next(it);
+    }
+    return index;
+}
+
+double bitErrorRate(const QVector<quint32> &a, const QVector<quint32> &b, int offset, int *overlap) {
+    // offset = frame in a - frame in b
+    const int startA = std::max(0, offset);
+    const int startB = std::max(0, -offset);
+    const int count = std::min(a.size() - startA, b.size() - startB);
+    *overlap = std::max(0, count);
+    if (count <= 0) {
+        return 1.0;
+    }
+    qint64 errors = 0;
+    const quint32 *pa = a.constData() + startA;
+    const quint32 *pb = b.constData() + startB;
+    for (int i = 0; i < count; ++i) {
+        errors += qPopulationCount(pa[i] ^ pb[i]);
+    }
+    return static_cast<double>(errors) / (32.0 * count);
+}
+
+int findRoot(QVector<int> &parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+}
+
+QVector<quint32> computeFingerprint(const QVector<float> &mono, int sampleRate) {
+    QVector<quint32> out;
+    if (sampleRate <= 0 || mono.size() < kFrameSize) {
+        return out;
+    }
+
+    RealFft fft(kFrameSize);
+    QVector<int> bandEdges(kBandCount + 1);
+    for (int b = 0; b <= kBandCount; ++b) {
+        const double hz = kMinBandHz * std::pow(kMaxBandHz / kMinBandHz, static_cast<double>(b) / kBandCount);
+        bandEdges[b] = std::clamp(static_cast<int>(std::lround(hz * kFrameSize / sampleRate)), 1,
+                                  fft.binCount() - 1);
+    }
+
+    QVector<float> power(fft.binCount());
+    QVector<double> previous(kBandCount, 0.0);
+    QVector<double> current(kBandCount, 0.0);
+    bool havePrevious = false;
+    out.reserve(static_cast<int>((mono.size() - kFrameSize) / kHopSize + 1));
+    for (qsizetype start = 0; start + kFrameSize <= mono.size(); start += kHopSize) {
+        fft.powerSpectrum(mono.constData() + start, power.data());
+        for (int b = 0; b < kBandCount; ++b) {
+            double sum = 0.0;
+            for (int k = bandEdges[b]; k < std::max(bandEdges[b] + 1, bandEdges[b + 1]); ++k) {
+                sum += power[k];
+            }
+            current[b] = sum;
+        }
+        if (havePrevious) {
+            quint32 bits = 0;
+            for (int m = 0; m < 32; ++m) {
+                const double delta =
+                    (current[m] - current[m + 1]) - (previous[m] - previous[m + 1]);
+                if (delta > 0.0) {
+                    bits |= (1u << m);
+                }
+            }
+            out.append(bits);
+        }
+        std::swap(previous, current);
+        havePrevious = true;
+    }
+    return out;
+}
+
+bool fingerprintFile(const QString &audioPath, QVector<quint32> *fingerprint, QString *error) {
+    const QString cacheFile =
+        audioCacheFilePath(QStringLiteral("fingerprints"), audioPath, QStringLiteral(".fp"));
+    if (readFingerprintFile(cacheFile, fingerprint)) {
+        return true;
+    }
+
+    AudioDecodeOptions options;
+    options.sampleRate = kFingerprintSampleRate;
+    options.channelCount = 1;
+    options.maxDurationMs = kMaxFingerprintMs;
+    QVector<float> mono;
+    AudioStreamInfo info;
+    if (!decodeAudioFile(audioPath, options, &mono, &info, error)) {
+        return false;
+    }
+    *fingerprint = computeFingerprint(mono, info.sampleRate);
+    if (fingerprint->isEmpty()) {
+        if (error) {
+            *error = QStringLiteral("Audio too short to fingerprint");
+        }
+        return false;
+    }
+    writeFingerprintFile(cacheFile, *fingerprint);
+    return true;
+}
+
+QList<QVector<int>> findDuplicateClusters(const QVector<QVector<quint32>> &fingerprints,
+                                          double maxBitErrorRate) {
+    const FingerprintIndex index = buildIndex(fingerprints);
+
+    QVector<int> tracks(fingerprints.size());
+    std::iota(tracks.begin(), tracks.end(), 0);
+    const QList<QVector<int>> matches = QtConcurrent::blockingMapped<QList<QVector<int>>>(
+        tracks, [&fingerprints, &index, maxBitErrorRate](int a) {
+            const QVector<quint32> &fa = fingerprints[a];
+            QHash<qint64, int> votes;
+            const int frames = std::min<int>(fa.size(), kQueryFrames);
+            for (int i = 0; i < frames; ++i) {
+                const auto it = index.constFind(fa[i]);
+                if (it == index.cend()) {
+                    continue;
+                }
+                for (const Posting &p : it.value()) {
+                    if (p.track <= a) {
+                        continue;
+                    }
+                    const qint64 key = (static_cast<qint64>(p.track) << 32) | static_cast<quint32>(i - p.frame);
+                    ++votes[key];
+                }
+            }
+
+            QHash<int, QPair<int, int>> bestOffset;
+            for (auto it = votes.cbegin(); it != votes.cend(); ++it) {
+                if (it.value() < kMinVotes) {
+                    continue;
+                }
+                const int b = static_cast<int>(it.key() >> 32);
+                const int offset = static_cast<qint32>(static_cast<quint32>(it.key() & 0xffffffffu));
+                auto best = bestOffset.find(b);
+                if (best == bestOffset.end() || best->second < it.value()) {
+                    bestOffset.insert(b, {offset, it.value()});
+                }
+            }
+
+            QVector<int> out;
+            for (auto it = bestOffset.cbegin(); it != bestOffset.cend(); ++it) {
+                int overlap = 0;
+                const double ber = bitErrorRate(fa, fingerprints[it.key()], it->first, &overlap);
+                if (overlap >= kMinOverlapFrames && ber <= maxBitErrorRate) {
+                    out.append(it.key());
+                }
+            }
+            return out;
+        });
+
+    QVector<int> parent(fingerprints.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (int a = 0; a < matches.size(); ++a) {
+        for (const int b : matches[a]) {
+            const int ra = findRoot(parent, a);
+            const int rb = findRoot(parent, b);
+            if (ra != rb) {
+                parent[std::max(ra, rb)] = std::min(ra, rb);
+            }
+        }
+    }
+
+    QHash<int, QVector<int>> groups;
+    for (int i = 0; i < parent.size(); ++i) {
+        groups[findRoot(parent, i)].append(i);
+    }
+    QList<QVector<int>> clusters;
+    for (auto it = groups.cbegin(); it != groups.cend(); ++it) {
+        if (it.value().size() > 1) {
+            clusters.append(it.value());
+        }
+    }
+    std::sort(clusters.begin(), clusters.end(),
+              [](const QVector<int> &x, const QVector<int> &y) { return x.first() < y.first(); });
+    return clusters;
+}
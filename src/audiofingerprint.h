@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// One 32-bit sub-fingerprint per ~46 ms hop: each bit is the sign of the
+// time derivative of the energy difference between adjacent spectral bands.
+QVector<quint32> computeFingerprint(const QVector<float> &mono, int sampleRate);
+bool fingerprintFile(const QString &audioPath, QVector<quint32> *fingerprint, QString *error = nullptr);
+
+// Groups fingerprints whose best alignment has a bit error rate at or below
+// maxBitErrorRate. Candidates come from a hash index over sub-fingerprints,
+// so only pairs that share exact sub-fingerprints are ever compared.
+QList<QVector<int>> findDuplicateClusters(const QVector<QVector<quint32>> &fingerprints,
+                                          double maxBitErrorRate = 0.35);
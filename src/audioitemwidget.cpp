@@ -1,8 +1,14 @@
 #include "audioitemwidget.h"
+#include "pcmplayer.h"
 #include "plaintextedit.h"
+#include "spectrogramcache.h"
+#include "tracing.h"
+#include "waveformcache.h"
 
+#include <QAction>
 #include <QAudioOutput>
 #include <QCheckBox>
+#include <QColor>
 #include <QComboBox>
 #include <QFileInfo>
 #include <QGridLayout>
@@ -12,27 +18,30 @@
 #include <QMediaPlayer>
 #include <QMenu>
 #include <QMouseEvent>
+#include <QPainter>
+#include <QPixmap>
 #include <QPushButton>
 #include <QFrame>
+#include <QGuiApplication>
 #include <QSignalBlocker>
 #include <QScrollBar>
 #include <QSizePolicy>
 #include <QSlider>
 #include <QStyle>
 #include <QTimer>
+#include <QToolButton>
+#include <QTextCharFormat>
+#include <QTextCursor>
 #include <QTextEdit>
 #include <QTextDocument>
 #include <QFontMetrics>
 #include <QUrl>
 #include <QVBoxLayout>
 #include <cmath>
+#include <functional>
 #include <memory>
 
 namespace {
-QStringList languages() {
-    return {"instrumental", "en", "zh", "ja", "ko", "es", "fr", "de", "pt", "ru"};
-}
-
 constexpr const char *kFieldCaption = "caption";
 constexpr const char *kFieldGenre = "genre";
 constexpr const char *kFieldLyrics = "lyrics";
@@ -40,13 +49,32 @@ constexpr const char *kFieldBpm = "bpm";
 constexpr const char *kFieldKey = "keyscale";
 constexpr const char *kFieldTimeSig = "timesignature";
 constexpr const char *kFieldDuration = "duration";
+constexpr const char *kFieldLanguage = "language";
+constexpr const char *kFieldInstrumental = "is_instrumental";
+constexpr const char *kFieldPromptOverride = "prompt_override";
+constexpr const char *kFieldAudioPath = "audio_path";
 
 class ClickSeekSlider : public QSlider {
 public:
     explicit ClickSeekSlider(Qt::Orientation orientation, QWidget *parent = nullptr)
         : QSlider(orientation, parent) {}
 
+    void setWaveformSource(const QString &audioPath) {
+        m_waveformPath = audioPath;
+        update();
+    }
+
 protected:
+    void paintEvent(QPaintEvent *event) override {
+        if (!m_waveformPath.isEmpty()) {
+            if (const WaveformPeaks *peaks = WaveformCache::instance()->peaks(m_waveformPath, this)) {
+                QPainter painter(this);
+                paintWaveform(painter, *peaks);
+            }
+        }
+        QSlider::paintEvent(event);
+    }
+
     void mousePressEvent(QMouseEvent *event) override {
         if (event->button() == Qt::LeftButton) {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -68,6 +96,127 @@ protected:
         }
         QSlider::mousePressEvent(event);
     }
+
+private:
+    void paintWaveform(QPainter &painter, const WaveformPeaks &peaks) const {
+        const QRect area = rect().adjusted(4, 2, -4, -2);
+        const int columns = area.width();
+        if (columns <= 0 || area.height() <= 0) {
+            return;
+        }
+        const int level = peaks.levelForWidth(columns);
+        const int buckets = peaks.bucketCount(level);
+        if (buckets <= 0) {
+            return;
+        }
+        const qint8 *data = peaks.levels[level].constData();
+        const int mid = area.center().y();
+        const int half = area.height() / 2;
+        const int playedColumns =
+            maximum() > minimum()
+                ? static_cast<int>(static_cast<qint64>(value() - minimum()) * columns / (maximum() - minimum()))
+                : 0;
+
+        QVector<QLine> played;
+        QVector<QLine> remaining;
+        played.reserve(playedColumns);
+        remaining.reserve(columns - playedColumns);
+        for (int x = 0; x < columns; ++x) {
+            const int from = static_cast<int>(static_cast<qint64>(x) * buckets / columns);
+            const int to = qMax(from + 1, static_cast<int>(static_cast<qint64>(x + 1) * buckets / columns));
+            int lo = data[from * 2];
+            int hi = data[from * 2 + 1];
+            for (int b = from + 1; b < to && b < buckets; ++b) {
+                lo = qMin(lo, static_cast<int>(data[b * 2]));
+                hi = qMax(hi, static_cast<int>(data[b * 2 + 1]));
+            }
+            const QLine line(area.left() + x, mid - hi * half / 127, area.left() + x, mid - lo * half / 127);
+            (x < playedColumns ? played : remaining).append(line);
+        }
+        painter.setPen(QColor("#6f9bd8"));
+        painter.drawLines(played);
+        painter.setPen(QColor("#4e596b"));
+        painter.drawLines(remaining);
+    }
+
+    QString m_waveformPath;
+};
+
+class SpectrogramView : public QWidget {
+public:
+    SpectrogramView(const QString &audioPath, std::function<void(qint64)> seek, QWidget *parent)
+        : QWidget(parent), m_audioPath(audioPath), m_seek(std::move(seek)) {
+        setFixedHeight(96);
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+        setCursor(Qt::PointingHandCursor);
+        setToolTip("Spectrogram (60 Hz - 5 kHz, log scale). Click to seek.");
+    }
+
+    void setPosition(qint64 positionMs) {
+        if (m_durationMs <= 0) {
+            m_positionMs = positionMs;
+            return;
+        }
+        const int oldX = xForPosition(m_positionMs);
+        m_positionMs = positionMs;
+        const int newX = xForPosition(positionMs);
+        if (newX != oldX) {
+            update(QRect(qMin(oldX, newX) - 1, 0, qAbs(newX - oldX) + 3, height()));
+        }
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter painter(this);
+        painter.fillRect(rect(), QColor("#1f2530"));
+        SpectrogramCache *cache = SpectrogramCache::instance();
+        const QImage *image = cache->image(m_audioPath, this);
+        if (!image) {
+            const bool failed = cache->hasFailed(m_audioPath);
+            painter.setPen(QColor(failed ? "#b06a6a" : "#5f6876"));
+            painter.drawText(rect(), Qt::AlignCenter,
+                             failed ? "Spectrogram unavailable: the audio could not be decoded"
+                                    : "Computing spectrogram...");
+            return;
+        }
+        if (image->cacheKey() != m_sourceKey || m_scaled.size() != size()) {
+            // Scaled once per resize; scrolling only blits the pixmap.
+            m_scaled = QPixmap::fromImage(image->scaled(size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+            m_sourceKey = image->cacheKey();
+            m_durationMs = image->text(QStringLiteral("duration_ms")).toLongLong();
+        }
+        painter.drawPixmap(0, 0, m_scaled);
+        if (m_durationMs > 0) {
+            const int x = xForPosition(m_positionMs);
+            painter.setPen(QColor(255, 255, 255, 200));
+            painter.drawLine(x, 0, x, height());
+        }
+    }
+
+    void mousePressEvent(QMouseEvent *event) override {
+        if (event->button() == Qt::LeftButton && m_durationMs > 0 && width() > 0 && m_seek) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+            const qreal x = event->position().x();
+#else
+            const qreal x = event->pos().x();
+#endif
+            m_seek(qBound<qint64>(0, static_cast<qint64>(x * m_durationMs / width()), m_durationMs));
+        }
+        QWidget::mousePressEvent(event);
+    }
+
+private:
+    int xForPosition(qint64 positionMs) const {
+        return m_durationMs > 0 ? static_cast<int>(qBound<qint64>(0, positionMs, m_durationMs) * width() / m_durationMs)
+                                : 0;
+    }
+
+    QString m_audioPath;
+    std::function<void(qint64)> m_seek;
+    QPixmap m_scaled;
+    qint64 m_sourceKey = 0;
+    qint64 m_durationMs = 0;
+    qint64 m_positionMs = 0;
 };
 }
 
@@ -106,6 +255,10 @@ void AudioItemWidget::setupUi() {
     auto *playerTop = new QHBoxLayout();
     playerTop->setSpacing(8);
 
+    m_selectCheck = new QCheckBox(m_leftPanel);
+    m_selectCheck->setToolTip("Select for bulk actions (Shift+click selects a range)");
+    playerTop->addWidget(m_selectCheck);
+
     m_indexLabel = new QLabel(QString::number(m_index), m_leftPanel);
     QFont idxFont = m_indexLabel->font();
     idxFont.setPointSize(idxFont.pointSize() + 3);
@@ -121,7 +274,10 @@ void AudioItemWidget::setupUi() {
     m_fileNameLabel->setToolTip(m_data.filename.isEmpty() ? QFileInfo(m_data.audioPath).fileName() : m_data.filename);
     m_fileNameLabel->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
     m_playPauseButton = new QPushButton("Play", m_leftPanel);
-    m_seekSlider = new ClickSeekSlider(Qt::Horizontal, m_leftPanel);
+    auto *seekSlider = new ClickSeekSlider(Qt::Horizontal, m_leftPanel);
+    seekSlider->setWaveformSource(m_data.audioPath);
+    seekSlider->setMinimumHeight(34);
+    m_seekSlider = seekSlider;
     m_seekSlider->setRange(0, 0);
     m_playPauseButton->setFixedWidth(90);
     playerTop->addWidget(m_playPauseButton, 0, Qt::AlignRight);
@@ -175,7 +331,7 @@ void AudioItemWidget::setupUi() {
     m_durationEdit->setContextMenuPolicy(Qt::CustomContextMenu);
 
     m_languageCombo = new QComboBox(this);
-    m_languageCombo->addItems(languages());
+    m_languageCombo->addItems(trackLanguages());
     const int langIndex = m_languageCombo->findText(m_data.language);
     m_languageCombo->setCurrentIndex(langIndex >= 0 ? langIndex : 0);
 
@@ -223,7 +379,17 @@ void AudioItemWidget::setupUi() {
     fields->addWidget(languageLabel, 6, 0);
     fields->addWidget(m_languageCombo, 6, 1);
     fields->addWidget(m_applyLangAllBtn, 6, 2, 1, 2);
-    fields->addWidget(m_instrumentalCheck, 6, 4);
+    m_instrumentalSuggestionBtn = new QToolButton(this);
+    m_instrumentalSuggestionBtn->setIcon(style()->standardIcon(QStyle::SP_DialogApplyButton));
+    m_instrumentalSuggestionBtn->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+    m_instrumentalSuggestionBtn->setAutoRaise(true);
+    m_instrumentalSuggestionBtn->setVisible(false);
+    auto *instrumentalRow = new QHBoxLayout();
+    instrumentalRow->setSpacing(2);
+    instrumentalRow->addWidget(m_instrumentalCheck);
+    instrumentalRow->addWidget(m_instrumentalSuggestionBtn);
+    instrumentalRow->addStretch(1);
+    fields->addLayout(instrumentalRow, 6, 4);
     promptOverrideLabel->setToolTip(promptOverrideTip);
     fields->addWidget(promptOverrideLabel, 7, 0);
     fields->addWidget(m_promptOverrideCombo, 7, 1, 1, 2);
@@ -232,6 +398,8 @@ void AudioItemWidget::setupUi() {
                                durationLabel,   m_durationEdit,     languageLabel, m_languageCombo,
                                m_applyLangAllBtn, m_instrumentalCheck, promptOverrideLabel,
                                m_promptOverrideCombo};
+    lyricsLabel->setAlignment(Qt::AlignLeft | Qt::AlignBottom);
+    m_fieldsLayout = fields;
     fields->setRowStretch(1, 1);
     fields->setRowStretch(5, 2);
     fields->setRowStretch(6, 0);
@@ -271,6 +439,13 @@ void AudioItemWidget::setupUi() {
         "  border-radius: 8px;"
         "  background-color: #1f252e;"
         "}"
+        "QWidget#TrackCard[selected=\"true\"] {"
+        "  border-color: #4a90d9;"
+        "  background-color: #212b38;"
+        "}"
+        "QWidget#TrackCard[searchCurrent=\"true\"] {"
+        "  border-color: #d8b04a;"
+        "}"
         "QFrame#TrackHeader {"
         "  border: 1px solid #5f6876;"
         "  border-radius: 6px;"
@@ -301,6 +476,10 @@ void AudioItemWidget::connectSignals() {
     connect(m_expandCaptionBtn, &QPushButton::clicked, this, &AudioItemWidget::onExpandCaptionClicked);
     connect(m_expandLyricsBtn, &QPushButton::clicked, this, &AudioItemWidget::onExpandLyricsClicked);
     connect(m_deleteBtn, &QPushButton::clicked, this, [this]() { emit deleteRequested(this); });
+    connect(m_selectCheck, &QCheckBox::clicked, this, [this](bool checked) {
+        setSelected(checked);
+        emit selectionClicked(this, checked, QGuiApplication::keyboardModifiers() & Qt::ShiftModifier);
+    });
     connect(m_saveBtn, &QPushButton::clicked, this, [this]() { emit saveRequested(); });
     connect(m_applyLangAllBtn, &QPushButton::clicked, this, [this]() {
         emit languageApplyAllRequested(m_languageCombo->currentText());
@@ -315,7 +494,31 @@ void AudioItemWidget::connectSignals() {
     connect(m_durationEdit, &QLineEdit::textChanged, this, &AudioItemWidget::triggerChanged);
     connect(m_languageCombo, &QComboBox::currentTextChanged, this, &AudioItemWidget::triggerChanged);
     connect(m_promptOverrideCombo, &QComboBox::currentTextChanged, this, &AudioItemWidget::triggerChanged);
-    connect(m_instrumentalCheck, &QCheckBox::toggled, this, [this](bool) { emit changed(); });
+    connect(m_instrumentalCheck, &QCheckBox::toggled, this, [this](bool) {
+        schedulePendingEdit();
+        updateInstrumentalSuggestion();
+        emit changed();
+    });
+    connect(m_instrumentalSuggestionBtn, &QToolButton::clicked, this, [this]() {
+        // The language suggestion rides along so both land in one undo step.
+        for (const char *field : {kFieldInstrumental, kFieldLanguage}) {
+            const auto it = m_suggestions.constFind(QLatin1String(field));
+            if (it != m_suggestions.cend()) {
+                const QString value = it->value;
+                m_suggestions.remove(QLatin1String(field));
+                setFieldValue(QLatin1String(field), value);
+            }
+        }
+        commitPendingEdit();
+        updateInstrumentalSuggestion();
+        // Vocals were found but no language was suggested with them, so the
+        // sample would keep language "instrumental"; ask for one right away.
+        if (!m_instrumentalCheck->isChecked() &&
+            fieldValue(QLatin1String(kFieldLanguage)) == QLatin1String("instrumental")) {
+            m_languageCombo->setFocus();
+            m_languageCombo->showPopup();
+        }
+    });
 
     auto connectLineContextMenu = [this](QLineEdit *edit, const QString &field) {
         connect(edit, &QWidget::customContextMenuRequested, this, [this, edit, field](const QPoint &pos) {
@@ -372,7 +575,49 @@ TrackData AudioItemWidget::data() const {
     return out;
 }
 
+QString AudioItemWidget::trackId() const {
+    return m_data.id;
+}
+
+QString AudioItemWidget::captionText() const {
+    return m_captionEdit->toPlainText();
+}
+
+QString AudioItemWidget::fieldValue(const QString &field) const {
+    if (field == QLatin1String(kFieldCaption)) {
+        return m_captionEdit->toPlainText();
+    }
+    if (field == QLatin1String(kFieldGenre)) {
+        return m_genreEdit->text();
+    }
+    if (field == QLatin1String(kFieldLyrics)) {
+        return m_lyricsEdit->toPlainText();
+    }
+    if (field == QLatin1String(kFieldBpm)) {
+        return m_bpmEdit->text();
+    }
+    if (field == QLatin1String(kFieldKey)) {
+        return m_keyEdit->text();
+    }
+    if (field == QLatin1String(kFieldTimeSig)) {
+        return m_timeSigEdit->text();
+    }
+    if (field == QLatin1String(kFieldDuration)) {
+        return m_durationEdit->text();
+    }
+    if (field == QLatin1String(kFieldLanguage)) {
+        return m_languageCombo->currentText();
+    }
+    if (field == QLatin1String(kFieldInstrumental)) {
+        return m_instrumentalCheck->isChecked() ? QStringLiteral("true") : QStringLiteral("false");
+    }
+    return trackFieldValue(data(), field);
+}
+
 void AudioItemWidget::setIndex(int index) {
+    if (index == m_index) {
+        return;
+    }
     m_index = index;
     m_indexLabel->setText(QString::number(index));
 }
@@ -442,6 +687,19 @@ void AudioItemWidget::setFieldValue(const QString &field, const QString &value)
         m_timeSigEdit->setText(value);
     } else if (field == QLatin1String(kFieldDuration)) {
         m_durationEdit->setText(value);
+    } else if (field == QLatin1String(kFieldLanguage)) {
+        const int idx = m_languageCombo->findText(value);
+        if (idx >= 0) {
+            m_languageCombo->setCurrentIndex(idx);
+        }
+    } else if (field == QLatin1String(kFieldInstrumental)) {
+        m_instrumentalCheck->setChecked(value == QLatin1String("true"));
+    } else if (field == QLatin1String(kFieldPromptOverride)) {
+        m_promptOverrideCombo->setCurrentText(value == QLatin1String("caption") ? "Caption"
+                                              : value == QLatin1String("genre") ? "Genre"
+                                                                                : "Use Global Ratio");
+    } else if (field == QLatin1String(kFieldAudioPath)) {
+        setAudioPath(value);
     }
     updateDirtyHighlight();
 }
@@ -461,6 +719,7 @@ void AudioItemWidget::setCaptionLyricsOnlyMode(bool enabled) {
             w->setVisible(!enabled);
         }
     }
+    updateInstrumentalSuggestion();
     updateHeights();
 }
 
@@ -499,8 +758,15 @@ void AudioItemWidget::updateStickyPosition() {
 }
 
 void AudioItemWidget::onPlayPause() {
+    m_playbackPrefetched = false;
     emit playbackControlActivated(this);
-    if (m_player->playbackState() == QMediaPlayer::PlayingState) {
+    if (m_pcmPlaybackEnabled && ensurePcmPlayer()) {
+        if (m_pcmPlayer->playbackState() == QMediaPlayer::PlayingState) {
+            m_pcmPlayer->pause();
+        } else {
+            m_pcmPlayer->play();
+        }
+    } else if (m_player->playbackState() == QMediaPlayer::PlayingState) {
         m_player->pause();
     } else {
         m_player->play();
@@ -514,6 +780,7 @@ void AudioItemWidget::onDurationChanged(qint64 durationMs) {
         const int sec = static_cast<int>(durationMs / 1000);
         if (sec > 0) {
             m_durationEdit->setText(QString::number(sec));
+            m_undoBaseline.duration = sec;
         }
     }
 }
@@ -530,6 +797,9 @@ void AudioItemWidget::onPositionChanged(qint64 positionMs) {
         m_seekTargetMs = -1;
     }
     m_seekSlider->setValue(static_cast<int>(positionMs));
+    if (m_spectrogramView) {
+        static_cast<SpectrogramView *>(m_spectrogramView)->setPosition(positionMs);
+    }
     updatePlayButtonText();
 }
 
@@ -571,28 +841,347 @@ void AudioItemWidget::triggerChanged() {
         updateHeights();
     }
     updateDirtyHighlight();
+    schedulePendingEdit();
+    for (auto it = m_suggestions.cbegin(); it != m_suggestions.cend(); ++it) {
+        updateSuggestionAction(it.key());
+    }
     emit changed();
 }
 
+void AudioItemWidget::schedulePendingEdit() {
+    if (!m_savedInitialized) {
+        return;
+    }
+    if (!m_undoTimer) {
+        m_undoTimer = new QTimer(this);
+        m_undoTimer->setSingleShot(true);
+        m_undoTimer->setInterval(700);
+        connect(m_undoTimer, &QTimer::timeout, this, &AudioItemWidget::commitPendingEdit);
+    }
+    m_undoTimer->start();
+}
+
+void AudioItemWidget::commitPendingEdit() {
+    if (!m_undoTimer || !m_undoTimer->isActive()) {
+        return;
+    }
+    m_undoTimer->stop();
+    const TrackData cur = data();
+    QList<CardFieldEdit> edits;
+    const QStringList fields = undoableTrackFields();
+    for (const QString &field : fields) {
+        const QString before = trackFieldValue(m_undoBaseline, field);
+        const QString after = trackFieldValue(cur, field);
+        if (before != after) {
+            edits.append({this, field, before, after});
+        }
+    }
+    m_undoBaseline = cur;
+    if (!edits.isEmpty()) {
+        emit editCommitted(edits);
+    }
+}
+
+void AudioItemWidget::syncUndoBaseline() {
+    if (m_undoTimer) {
+        m_undoTimer->stop();
+    }
+    m_undoBaseline = data();
+}
+
+QString AudioItemWidget::focusedField() const {
+    for (const char *field : {kFieldCaption, kFieldLyrics, kFieldGenre, kFieldBpm, kFieldKey, kFieldTimeSig}) {
+        const QWidget *editor = editorForField(QLatin1String(field));
+        if (editor && editor->hasFocus()) {
+            return QLatin1String(field);
+        }
+    }
+    return {};
+}
+
+void AudioItemWidget::focusField(const QString &field) {
+    QWidget *editor = editorForField(field);
+    if (!editor || !editor->isVisibleTo(this)) {
+        editor = m_captionEdit;
+    }
+    editor->setFocus(Qt::OtherFocusReason);
+}
+
+bool AudioItemWidget::isFieldEmpty(const QString &field) const {
+    if (field == QLatin1String(kFieldBpm) || field == QLatin1String(kFieldDuration)) {
+        return fieldValue(field).toInt() <= 0;
+    }
+    return fieldValue(field).trimmed().isEmpty();
+}
+
+void AudioItemWidget::setFieldSuggestion(const QString &field, const QString &value, double confidence) {
+    m_suggestions.insert(field, {value, confidence});
+    updateSuggestionAction(field);
+}
+
+void AudioItemWidget::clearFieldSuggestion(const QString &field) {
+    if (m_suggestions.remove(field) > 0) {
+        updateSuggestionAction(field);
+    }
+}
+
+QHash<QString, FieldSuggestion> AudioItemWidget::fieldSuggestions() const {
+    return m_suggestions;
+}
+
+void AudioItemWidget::setLoudnessStats(const LoudnessStats &stats) {
+    m_loudness = stats;
+    if (!m_audioStatsLabel) {
+        m_audioStatsLabel = new QLabel(m_leftPanel);
+        m_audioStatsLabel->setWordWrap(true);
+        m_leftPanel->layout()->addWidget(m_audioStatsLabel);
+    }
+    const QStringList issues = loudnessIssues(stats);
+    m_audioStatsLabel->setText(loudnessSummary(stats));
+    m_audioStatsLabel->setToolTip(issues.isEmpty() ? QStringLiteral("No audio issues found") : issues.join('\n'));
+    m_audioStatsLabel->setStyleSheet(issues.isEmpty() ? QStringLiteral("QLabel { color: #9aa4b2; }")
+                                                      : QStringLiteral("QLabel { color: #d8b04a; }"));
+    m_audioStatsLabel->setVisible(stats.valid);
+    updateHeights();
+}
+
+LoudnessStats AudioItemWidget::loudnessStats() const {
+    return m_loudness;
+}
+
+QWidget *AudioItemWidget::editorForField(const QString &field) const {
+    if (field == QLatin1String(kFieldCaption)) {
+        return m_captionEdit;
+    }
+    if (field == QLatin1String(kFieldLyrics)) {
+        return m_lyricsEdit;
+    }
+    return lineEditForField(field);
+}
+
+QLineEdit *AudioItemWidget::lineEditForField(const QString &field) const {
+    if (field == QLatin1String(kFieldBpm)) {
+        return m_bpmEdit;
+    }
+    if (field == QLatin1String(kFieldKey)) {
+        return m_keyEdit;
+    }
+    if (field == QLatin1String(kFieldTimeSig)) {
+        return m_timeSigEdit;
+    }
+    if (field == QLatin1String(kFieldGenre)) {
+        return m_genreEdit;
+    }
+    return nullptr;
+}
+
+void AudioItemWidget::updateSuggestionAction(const QString &field) {
+    if (field == QLatin1String(kFieldInstrumental) || field == QLatin1String(kFieldLanguage)) {
+        updateInstrumentalSuggestion();
+        return;
+    }
+    QLineEdit *edit = lineEditForField(field);
+    if (!edit) {
+        return;
+    }
+    QAction *action = m_suggestionActions.value(field);
+    const auto it = m_suggestions.constFind(field);
+    if (it == m_suggestions.cend() || fieldValue(field) == it->value) {
+        if (action) {
+            action->setVisible(false);
+        }
+        return;
+    }
+    if (!action) {
+        action = edit->addAction(style()->standardIcon(QStyle::SP_DialogApplyButton),
+                                 QLineEdit::TrailingPosition);
+        connect(action, &QAction::triggered, this, [this, field]() { acceptFieldSuggestion(field); });
+        m_suggestionActions.insert(field, action);
+    }
+    action->setToolTip(QStringLiteral("Suggested: %1 (confidence %2%) - click to accept")
+                           .arg(it->value)
+                           .arg(qRound(it->confidence * 100.0)));
+    action->setVisible(true);
+}
+
+void AudioItemWidget::updateInstrumentalSuggestion() {
+    const auto it = m_suggestions.constFind(QLatin1String(kFieldInstrumental));
+    const bool show = it != m_suggestions.cend() && fieldValue(QLatin1String(kFieldInstrumental)) != it->value &&
+                      !m_captionLyricsOnlyMode;
+    m_instrumentalSuggestionBtn->setVisible(show);
+    if (!show) {
+        return;
+    }
+    const bool instrumental = it->value == QLatin1String("true");
+    const bool needsLanguage =
+        !instrumental && fieldValue(QLatin1String(kFieldLanguage)) == QLatin1String("instrumental");
+    m_instrumentalSuggestionBtn->setText(QStringLiteral("%1%").arg(qRound(it->confidence * 100.0)));
+    m_instrumentalSuggestionBtn->setToolTip(
+        QStringLiteral("Suggested: %1 (confidence %2%) - click to accept%3")
+            .arg(instrumental ? QStringLiteral("instrumental") : QStringLiteral("has vocals"))
+            .arg(qRound(it->confidence * 100.0))
+            .arg(needsLanguage ? QStringLiteral(", then choose the sung language") : QString()));
+}
+
+void AudioItemWidget::acceptFieldSuggestion(const QString &field) {
+    const auto it = m_suggestions.constFind(field);
+    if (it == m_suggestions.cend()) {
+        return;
+    }
+    const QString value = it->value;
+    m_suggestions.remove(field);
+    setFieldValue(field, value);
+    commitPendingEdit();
+    updateSuggestionAction(field);
+}
+
 void AudioItemWidget::updatePlayButtonText() {
-    m_playPauseButton->setText(m_player->playbackState() == QMediaPlayer::PlayingState ? "Pause" : "Play");
+    const bool playing = playbackState() == QMediaPlayer::PlayingState;
+    m_playPauseButton->setText(playing ? "Pause" : "Play");
+    if (playing != m_playing) {
+        m_playing = playing;
+        emit playingChanged(this, playing);
+    }
 }
 
 bool AudioItemWidget::isPlaying() const {
-    return m_player && m_player->playbackState() == QMediaPlayer::PlayingState;
+    return m_player && playbackState() == QMediaPlayer::PlayingState;
+}
+
+QMediaPlayer::PlaybackState AudioItemWidget::playbackState() const {
+    return m_pcmPlayer ? m_pcmPlayer->playbackState() : m_player->playbackState();
+}
+
+qint64 AudioItemWidget::playbackPosition() const {
+    return m_pcmPlayer ? m_pcmPlayer->position() : m_player->position();
 }
 
 void AudioItemWidget::togglePlayback() {
     onPlayPause();
 }
 
+void AudioItemWidget::prefetchPlayback() {
+    if (!m_player || m_data.audioPath.isEmpty() || playbackState() != QMediaPlayer::StoppedState) {
+        return;
+    }
+    if (m_pcmPlaybackEnabled) {
+        // Creating the engine starts decoding into its cache.
+        m_playbackPrefetched = ensurePcmPlayer();
+        return;
+    }
+    if (m_player->source().isEmpty()) {
+        m_player->setSource(QUrl::fromLocalFile(m_data.audioPath));
+    }
+    // Pausing from stopped makes the backend open the file, build its
+    // pipeline and buffer the start, so the next play() starts at once.
+    m_player->pause();
+    m_playbackPrefetched = true;
+}
+
+void AudioItemWidget::releasePlaybackPrefetch() {
+    if (!m_playbackPrefetched) {
+        return;
+    }
+    m_playbackPrefetched = false;
+    if (m_pcmPlayer) {
+        releasePcmPlayback();
+    } else if (m_player->playbackState() == QMediaPlayer::PausedState && m_player->position() == 0) {
+        m_player->stop();
+    }
+}
+
+void AudioItemWidget::setPcmPlaybackEnabled(bool enabled) {
+    if (m_pcmPlaybackEnabled == enabled) {
+        return;
+    }
+    m_pcmPlaybackEnabled = enabled;
+    if (!enabled && m_pcmPlayer) {
+        const bool wasPlaying = m_pcmPlayer->playbackState() == QMediaPlayer::PlayingState;
+        const qint64 position = m_pcmPlayer->position();
+        delete m_pcmPlayer;
+        m_pcmPlayer = nullptr;
+        m_player->setPosition(position);
+        if (wasPlaying) {
+            m_player->play();
+        }
+        updatePlayButtonText();
+    }
+}
+
+void AudioItemWidget::releasePcmPlayback() {
+    if (!m_pcmPlayer || m_pcmPlayer->playbackState() == QMediaPlayer::PlayingState) {
+        return;
+    }
+    m_player->setPosition(m_pcmPlayer->position());
+    m_pcmPlayer->deleteLater();
+    m_pcmPlayer = nullptr;
+    updatePlayButtonText();
+}
+
+bool AudioItemWidget::ensurePcmPlayer() {
+    if (m_pcmPlayer) {
+        return true;
+    }
+    if (m_pcmFailed || m_data.audioPath.isEmpty() || !QFileInfo::exists(m_data.audioPath)) {
+        return false;
+    }
+    if (m_player->playbackState() != QMediaPlayer::StoppedState) {
+        m_player->pause();
+    }
+    m_pcmPlayer = new PcmPlayer(m_data.audioPath, this);
+    m_pcmPlayer->setPosition(m_player->position());
+    connect(m_pcmPlayer, &PcmPlayer::positionChanged, this, &AudioItemWidget::onPositionChanged);
+    connect(m_pcmPlayer, &PcmPlayer::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState) {
+        updatePlayButtonText();
+    });
+    connect(m_pcmPlayer, &PcmPlayer::playbackFailed, this, [this]() {
+        // Fall back to the media backend for files the decoder or the audio
+        // device cannot handle, and stay there until the card gets another file.
+        m_pcmFailed = true;
+        const bool wasPlaying = m_pcmPlayer->playbackState() == QMediaPlayer::PlayingState;
+        m_pcmPlayer->deleteLater();
+        m_pcmPlayer = nullptr;
+        if (wasPlaying) {
+            m_player->play();
+        }
+        updatePlayButtonText();
+    });
+    return true;
+}
+
+void AudioItemWidget::setAudioPath(const QString &audioPath) {
+    if (m_data.audioPath == audioPath) {
+        return;
+    }
+    delete m_pcmPlayer;
+    m_pcmPlayer = nullptr;
+    m_pcmFailed = false;
+    m_playbackPrefetched = false;
+    m_player->stop();
+    if (m_data.filename == QFileInfo(m_data.audioPath).fileName()) {
+        m_data.filename = QFileInfo(audioPath).fileName();
+    }
+    m_data.audioPath = audioPath;
+    WaveformCache::instance()->retry(audioPath);
+    SpectrogramCache::instance()->retry(audioPath);
+    m_player->setSource(QUrl::fromLocalFile(audioPath));
+    static_cast<ClickSeekSlider *>(m_seekSlider)->setWaveformSource(audioPath);
+    m_seekSlider->setValue(0);
+    delete m_spectrogramView;
+    m_spectrogramView = nullptr;
+    updateSpectrogramVisibility();
+    updatePlayButtonText();
+    updateHeights();
+}
+
 void AudioItemWidget::seekRelativeMs(qint64 deltaMs) {
     if (!m_player) {
         return;
     }
+    m_playbackPrefetched = false;
     emit playbackControlActivated(this);
     const qint64 duration = m_player->duration();
-    qint64 target = m_player->position() + deltaMs;
+    qint64 target = playbackPosition() + deltaMs;
     if (duration > 0) {
         target = qBound<qint64>(0, target, duration);
     } else {
@@ -610,6 +1199,10 @@ void AudioItemWidget::seekToMs(qint64 targetMs) {
         return;
     }
     m_seekTargetMs = qMax<qint64>(0, targetMs);
+    if (m_pcmPlayer) {
+        m_pcmPlayer->setPosition(m_seekTargetMs);
+        return;
+    }
 
     // Reduce decoder/output click at seek boundaries by briefly muting output.
     const bool canMute = (m_audioOutput != nullptr);
@@ -627,7 +1220,56 @@ void AudioItemWidget::seekToMs(qint64 targetMs) {
     }
 }
 
+void AudioItemWidget::setSearchHighlight(const QStringList &terms) {
+    QTextCharFormat fmt;
+    fmt.setBackground(QColor(122, 98, 28));
+    fmt.setForeground(QColor(255, 244, 214));
+    auto highlight = [&terms, &fmt](QTextEdit *edit) {
+        QList<QTextEdit::ExtraSelection> selections;
+        for (const QString &term : terms) {
+            QTextCursor cursor(edit->document());
+            while (true) {
+                cursor = edit->document()->find(term, cursor);
+                if (cursor.isNull()) {
+                    break;
+                }
+                selections.append({cursor, fmt});
+            }
+        }
+        edit->setExtraSelections(selections);
+    };
+    highlight(m_captionEdit);
+    highlight(m_lyricsEdit);
+}
+
+void AudioItemWidget::setSearchCurrent(bool current) {
+    if (property("searchCurrent").toBool() == current) {
+        return;
+    }
+    setProperty("searchCurrent", current);
+    style()->unpolish(this);
+    style()->polish(this);
+    update();
+}
+
+void AudioItemWidget::setSelected(bool selected) {
+    const QSignalBlocker blocker(m_selectCheck);
+    m_selectCheck->setChecked(selected);
+    if (property("selected").toBool() == selected) {
+        return;
+    }
+    setProperty("selected", selected);
+    style()->unpolish(this);
+    style()->polish(this);
+    update();
+}
+
+bool AudioItemWidget::isSelected() const {
+    return m_selectCheck->isChecked();
+}
+
 void AudioItemWidget::updateHeights() {
+    TRACE_SCOPE("AudioItemWidget::updateHeights");
     const int captionBase = m_captionExpanded ? 140 : 70;
     const int lyricsBase = m_lyricsExpanded ? 240 : 120;
     const int captionPreset = qMax(50, (captionBase * m_uiScale) / 100);
@@ -673,6 +1315,34 @@ void AudioItemWidget::updateHeights() {
 void AudioItemWidget::updateExpandButtons() {
     m_expandCaptionBtn->setText(m_captionExpanded ? "Collapse Caption" : "Expand Caption");
     m_expandLyricsBtn->setText(m_lyricsExpanded ? "Collapse Lyrics" : "Expand Lyrics");
+    updateSpectrogramVisibility();
+}
+
+void AudioItemWidget::setSpectrogramEnabled(bool enabled) {
+    if (m_spectrogramEnabled == enabled) {
+        return;
+    }
+    m_spectrogramEnabled = enabled;
+    updateSpectrogramVisibility();
+    updateHeights();
+}
+
+void AudioItemWidget::updateSpectrogramVisibility() {
+    const bool show = m_spectrogramEnabled && m_lyricsExpanded && !m_data.audioPath.isEmpty();
+    if (show && !m_spectrogramView) {
+        m_spectrogramView = new SpectrogramView(
+            m_data.audioPath,
+            [this](qint64 positionMs) {
+                emit playbackControlActivated(this);
+                seekToMs(positionMs);
+                m_seekSlider->setValue(static_cast<int>(positionMs));
+            },
+            this);
+        m_fieldsLayout->addWidget(m_spectrogramView, 4, 1, 1, 4);
+    }
+    if (m_spectrogramView) {
+        m_spectrogramView->setVisible(show);
+    }
 }
 
 void AudioItemWidget::applyDurationIfEmpty() {
@@ -702,8 +1372,10 @@ void AudioItemWidget::resizeEvent(QResizeEvent *event) {
 }
 
 void AudioItemWidget::markSaved() {
+    commitPendingEdit();
     m_savedData = data();
     m_savedInitialized = true;
+    m_undoBaseline = m_savedData;
     updateDirtyHighlight();
 }
 
@@ -729,6 +1401,7 @@ void AudioItemWidget::updateDirtyHighlight() {
     applyDirtyStyle(m_languageCombo, cur.language != m_savedData.language);
     applyDirtyStyle(m_promptOverrideCombo, cur.promptOverride != m_savedData.promptOverride);
     applyDirtyStyle(m_instrumentalCheck, cur.isInstrumental != m_savedData.isInstrumental);
+    applyDirtyStyle(m_fileNameLabel, cur.audioPath != m_savedData.audioPath);
 }
 
 bool AudioItemWidget::isDirtyComparedToSaved() const {
@@ -742,7 +1415,8 @@ bool AudioItemWidget::isDirtyComparedToSaved() const {
            cur.duration != m_savedData.duration ||
            cur.language != m_savedData.language ||
            cur.promptOverride != m_savedData.promptOverride ||
-           cur.isInstrumental != m_savedData.isInstrumental;
+           cur.isInstrumental != m_savedData.isInstrumental ||
+           cur.audioPath != m_savedData.audioPath;
 }
 
 void AudioItemWidget::applyDirtyStyle(QWidget *w, bool dirty) {
@@ -769,4 +1443,8 @@ void AudioItemWidget::applyDirtyStyle(QWidget *w, bool dirty) {
         w->setStyleSheet("QTextEdit { border: 2px solid #d14a4a; background-color: #3b2323; }");
         return;
     }
+    if (qobject_cast<QLabel *>(w)) {
+        w->setStyleSheet("QLabel { color: #ff7b7b; }");
+        return;
+    }
 }
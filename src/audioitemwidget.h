@@ -1,20 +1,29 @@
 #pragma once
 
+#include "loudnessanalyzer.h"
+#include "trackedits.h"
+
+#include <QHash>
+#include <QMediaPlayer>
 #include <QWidget>
 #include <QList>
 
+class QAction;
 class QAudioOutput;
 class QCheckBox;
 class QComboBox;
 class QFrame;
+class QGridLayout;
 class QLabel;
 class QLineEdit;
 class PlainTextEdit;
+class PcmPlayer;
 class QPushButton;
 class QSlider;
 class QTextEdit;
-class QMediaPlayer;
 class QResizeEvent;
+class QTimer;
+class QToolButton;
 
 struct TrackData {
     QString id;
@@ -34,6 +43,11 @@ struct TrackData {
     QString promptOverride;
 };
 
+struct FieldSuggestion {
+    QString value;
+    double confidence = 0.0;
+};
+
 class AudioItemWidget : public QWidget {
     Q_OBJECT
 
@@ -41,6 +55,9 @@ public:
     explicit AudioItemWidget(int index, const TrackData &data, QWidget *parent = nullptr);
 
     TrackData data() const;
+    QString trackId() const;
+    QString captionText() const;
+    QString fieldValue(const QString &field) const;
     void markSaved();
     bool hasUnsavedChanges() const;
     void setIndex(int index);
@@ -57,15 +74,39 @@ public:
     void updateStickyPosition();
     bool isPlaying() const;
     void togglePlayback();
+    void prefetchPlayback();
+    void releasePlaybackPrefetch();
+    void setPcmPlaybackEnabled(bool enabled);
+    void releasePcmPlayback();
+    void setSpectrogramEnabled(bool enabled);
     void seekRelativeMs(qint64 deltaMs);
+    void setSearchHighlight(const QStringList &terms);
+    void setSearchCurrent(bool current);
+    void setSelected(bool selected);
+    bool isSelected() const;
+    void commitPendingEdit();
+    void syncUndoBaseline();
+    bool isFieldEmpty(const QString &field) const;
+    // Field key of the editor holding keyboard focus, or empty.
+    QString focusedField() const;
+    void focusField(const QString &field);
+    void setFieldSuggestion(const QString &field, const QString &value, double confidence);
+    void clearFieldSuggestion(const QString &field);
+    QHash<QString, FieldSuggestion> fieldSuggestions() const;
+    void setLoudnessStats(const LoudnessStats &stats);
+    LoudnessStats loudnessStats() const;
 
 signals:
     void deleteRequested(AudioItemWidget *self);
     void saveRequested();
     void playbackControlActivated(AudioItemWidget *self);
+    void playingChanged(AudioItemWidget *self, bool playing);
+    // extend is set for a shift-click, which selects a range.
+    void selectionClicked(AudioItemWidget *self, bool selected, bool extend);
     void languageApplyAllRequested(const QString &language);
     void fieldApplyAllRequested(const QString &field, const QString &value);
     void changed();
+    void editCommitted(const QList<CardFieldEdit> &edits);
     void layoutSizeChanged();
 
 private slots:
@@ -78,6 +119,7 @@ private slots:
     void onExpandCaptionClicked();
     void onExpandLyricsClicked();
     void triggerChanged();
+    void schedulePendingEdit();
 
 private:
     void setupUi();
@@ -88,24 +130,46 @@ private:
     void updatePlayButtonText();
     void updateHeights();
     void updateExpandButtons();
+    void updateSpectrogramVisibility();
     void applyDurationIfEmpty();
     void seekToMs(qint64 targetMs);
+    QMediaPlayer::PlaybackState playbackState() const;
+    qint64 playbackPosition() const;
+    bool ensurePcmPlayer();
+    void setAudioPath(const QString &audioPath);
     int contentHeightFor(QTextEdit *edit, int minHeight, int maxHeight = 5000) const;
+    QWidget *editorForField(const QString &field) const;
+    QLineEdit *lineEditForField(const QString &field) const;
+    void updateSuggestionAction(const QString &field);
+    void acceptFieldSuggestion(const QString &field);
+    void updateInstrumentalSuggestion();
     void resizeEvent(QResizeEvent *event) override;
 
     int m_index = 1;
+    bool m_playing = false;
     bool m_captionExpanded = false;
     bool m_lyricsExpanded = false;
     bool m_updatingSlider = false;
     bool m_userSeeking = false;
+    bool m_playbackPrefetched = false;
+    bool m_pcmPlaybackEnabled = false;
+    // Set once the PCM decoder has failed on the current file.
+    bool m_pcmFailed = false;
+    bool m_spectrogramEnabled = false;
     qint64 m_seekTargetMs = -1;
     int m_uiScale = 100;
     bool m_savedInitialized = false;
 
     TrackData m_data;
     TrackData m_savedData;
+    TrackData m_undoBaseline;
+    QTimer *m_undoTimer = nullptr;
+    QHash<QString, FieldSuggestion> m_suggestions;
+    QHash<QString, QAction *> m_suggestionActions;
+    LoudnessStats m_loudness;
 
     QLabel *m_indexLabel = nullptr;
+    QCheckBox *m_selectCheck = nullptr;
     QLabel *m_fileNameLabel = nullptr;
     QWidget *m_leftHost = nullptr;
     QFrame *m_leftPanel = nullptr;
@@ -115,8 +179,12 @@ private:
     int m_lastStickyOffset = -1;
     QPushButton *m_playPauseButton = nullptr;
     QSlider *m_seekSlider = nullptr;
+    QLabel *m_audioStatsLabel = nullptr;
+    QWidget *m_spectrogramView = nullptr;
+    QGridLayout *m_fieldsLayout = nullptr;
     QMediaPlayer *m_player = nullptr;
     QAudioOutput *m_audioOutput = nullptr;
+    PcmPlayer *m_pcmPlayer = nullptr;
 
     PlainTextEdit *m_captionEdit = nullptr;
     QLineEdit *m_genreEdit = nullptr;
@@ -129,6 +197,7 @@ private:
     QComboBox *m_promptOverrideCombo = nullptr;
     QPushButton *m_applyLangAllBtn = nullptr;
     QCheckBox *m_instrumentalCheck = nullptr;
+    QToolButton *m_instrumentalSuggestionBtn = nullptr;
     QPushButton *m_deleteBtn = nullptr;
     QPushButton *m_saveBtn = nullptr;
     QPushButton *m_expandCaptionBtn = nullptr;
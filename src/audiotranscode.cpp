@@ -0,0 +1,236 @@
+#include "audiotranscode.h"
+
+#include "audiodecode.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int kBitsPerSample = 16;
+// The RIFF size field also covers the header chunks.
+constexpr qint64 kMaxDataBytes = 0xFFFFFFFFLL - 128;
+constexpr int kMaxHeaderChunks = 32;
+// Private chunk naming the source a file was transcoded from, as its
+// audioCacheKey(); other readers skip unknown chunks.
+constexpr char kSourceChunkId[] = "srck";
+
+struct WavFormat {
+    int formatTag = 0;
+    int channelCount = 0;
+    int sampleRate = 0;
+    int bitsPerSample = 0;
+    qint64 dataBytes = 0;
+    QByteArray sourceKey;
+};
+
+bool readWavFormat(const QString &path, WavFormat *format) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray riff = file.read(12);
+    if (riff.size() != 12 || !riff.startsWith("RIFF") || riff.mid(8, 4) != "WAVE") {
+        return false;
+    }
+    bool haveFormat = false;
+    for (int i = 0; i < kMaxHeaderChunks; ++i) {
+        const QByteArray chunk = file.read(8);
+        if (chunk.size() != 8) {
+            return false;
+        }
+        const quint32 size = qFromLittleEndian<quint32>(chunk.constData() + 4);
+        if (chunk.startsWith("fmt ")) {
+            const QByteArray fmt = file.read(size);
+            if (fmt.size() < 16) {
+                return false;
+            }
+            format->formatTag = qFromLittleEndian<quint16>(fmt.constData());
+            format->channelCount = qFromLittleEndian<quint16>(fmt.constData() + 2);
+            format->sampleRate = static_cast<int>(qFromLittleEndian<quint32>(fmt.constData() + 4));
+            format->bitsPerSample = qFromLittleEndian<quint16>(fmt.constData() + 14);
+            haveFormat = true;
+        } else if (chunk.startsWith("data")) {
+            format->dataBytes = size;
+            return haveFormat;
+        } else if (chunk.startsWith(kSourceChunkId) && size <= 256) {
+            format->sourceKey = file.read(size);
+        } else if (!file.seek(file.pos() + size)) {
+            return false;
+        }
+        // Chunks are padded to an even length.
+        if ((size & 1) != 0 && !file.seek(file.pos() + 1)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+QByteArray wavHeader(int sampleRate, int channelCount, const QByteArray &sourceKey, quint32 dataBytes) {
+    QByteArray header;
+    header.reserve(52 + sourceKey.size());
+    const auto put16 = [&header](quint16 value) {
+        char bytes[2];
+        qToLittleEndian(value, bytes);
+        header.append(bytes, 2);
+    };
+    const auto put32 = [&header](quint32 value) {
+        char bytes[4];
+        qToLittleEndian(value, bytes);
+        header.append(bytes, 4);
+    };
+    const int blockAlign = channelCount * kBitsPerSample / 8;
+    header.append("RIFF", 4);
+    put32(static_cast<quint32>(44 + sourceKey.size()) + dataBytes);
+    header.append("WAVE", 4);
+    header.append("fmt ", 4);
+    put32(16);
+    put16(1);
+    put16(static_cast<quint16>(channelCount));
+    put32(static_cast<quint32>(sampleRate));
+    put32(static_cast<quint32>(sampleRate * blockAlign));
+    put16(static_cast<quint16>(blockAlign));
+    put16(kBitsPerSample);
+    header.append(kSourceChunkId, 4);
+    put32(static_cast<quint32>(sourceKey.size()));
+    header.append(sourceKey);
+    header.append("data", 4);
+    put32(dataBytes);
+    return header;
+}
+
+double wavSeconds(const WavFormat &format) {
+    const int blockAlign = format.channelCount * format.bitsPerSample / 8;
+    return blockAlign > 0 && format.sampleRate > 0
+               ? static_cast<double>(format.dataBytes / blockAlign) / format.sampleRate
+               : 0.0;
+}
+}
+
+bool isNormalizedWav(const QString &path, int sampleRate, int channelCount) {
+    WavFormat format;
+    // 0xFFFE is WAVE_FORMAT_EXTENSIBLE, which some tools write even for plain PCM.
+    return readWavFormat(path, &format) && (format.formatTag == 1 || format.formatTag == 0xFFFE) &&
+           format.bitsPerSample == kBitsPerSample && format.sampleRate == sampleRate &&
+           format.channelCount == channelCount;
+}
+
+double wavDurationSeconds(const QString &path) {
+    WavFormat format;
+    return readWavFormat(path, &format) ? wavSeconds(format) : 0.0;
+}
+
+bool transcodeToWav(const QString &sourcePath, const TranscodeOptions &options, TranscodeOutcome *outcome,
+                    QString *error) {
+    const auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    const auto reuse = [outcome](const QString &path) {
+        WavFormat format;
+        readWavFormat(path, &format);
+        outcome->outputPath = path;
+        outcome->reused = true;
+        outcome->audioSeconds = wavSeconds(format);
+        return true;
+    };
+
+    const QFileInfo source(sourcePath);
+    if (!source.exists()) {
+        return fail(QStringLiteral("File not found"));
+    }
+    if (isNormalizedWav(sourcePath, options.sampleRate, options.channelCount)) {
+        return reuse(sourcePath);
+    }
+
+    // A sibling left by an earlier run on this same source is picked up
+    // instead of decoding again. Any other file of that name is left alone.
+    const QByteArray sourceKey = audioCacheKey(sourcePath).toLatin1();
+    const QString base = source.absolutePath() + QLatin1Char('/') + source.completeBaseName();
+    const QString fallback = base + QStringLiteral("_normalized.wav");
+    const QStringList candidates = {base + QStringLiteral(".wav"), fallback};
+    QString target;
+    for (const QString &candidate : candidates) {
+        const QFileInfo info(candidate);
+        if (info == source) {
+            continue;
+        }
+        if (!info.exists()) {
+            target = candidate;
+            break;
+        }
+        WavFormat format;
+        if (readWavFormat(candidate, &format) && format.sourceKey == sourceKey &&
+            isNormalizedWav(candidate, options.sampleRate, options.channelCount)) {
+            return reuse(candidate);
+        }
+    }
+    if (target.isEmpty()) {
+        target = fallback;
+    }
+
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(QStringLiteral("Cannot write %1: %2").arg(target, file.errorString()));
+    }
+    const QByteArray placeholder = wavHeader(options.sampleRate, options.channelCount, sourceKey, 0);
+    file.write(placeholder);
+
+    AudioDecodeOptions decode;
+    decode.sampleRate = options.sampleRate;
+    decode.channelCount = options.channelCount;
+    QByteArray pcm;
+    qint64 dataBytes = 0;
+    QString message;
+    const bool decoded = decodeAudioStream(
+        sourcePath, decode,
+        [&](const float *samples, qsizetype frames, const AudioStreamInfo &info) {
+            if (options.cancel && options.cancel->load()) {
+                message = QStringLiteral("Canceled");
+                return false;
+            }
+            const qsizetype count = frames * info.channelCount;
+            pcm.resize(count * static_cast<qsizetype>(sizeof(qint16)));
+            char *out = pcm.data();
+            for (qsizetype i = 0; i < count; ++i) {
+                const auto value = static_cast<qint16>(std::lround(std::clamp(samples[i], -1.0f, 1.0f) * 32767.0f));
+                qToLittleEndian(value, out + i * sizeof(qint16));
+            }
+            if (dataBytes + pcm.size() > kMaxDataBytes) {
+                message = QStringLiteral("Too long for a WAV file");
+                return false;
+            }
+            if (file.write(pcm) != pcm.size()) {
+                message = file.errorString();
+                return false;
+            }
+            dataBytes += pcm.size();
+            return true;
+        },
+        &message);
+    if (!decoded || !message.isEmpty() || dataBytes == 0) {
+        file.cancelWriting();
+        return fail(message.isEmpty() ? QStringLiteral("No audio decoded") : message);
+    }
+
+    if (!file.seek(0) || file.write(wavHeader(options.sampleRate, options.channelCount, sourceKey,
+                                              static_cast<quint32>(dataBytes))) != placeholder.size()) {
+        file.cancelWriting();
+        return fail(file.errorString());
+    }
+    if (!file.commit()) {
+        return fail(QStringLiteral("Cannot write %1: %2").arg(target, file.errorString()));
+    }
+    outcome->outputPath = target;
+    outcome->reused = false;
+    outcome->audioSeconds =
+        static_cast<double>(dataBytes) / (static_cast<double>(options.sampleRate) * options.channelCount * sizeof(qint16));
+    return true;
+}
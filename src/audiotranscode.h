@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+
+struct TranscodeOptions {
+    int sampleRate = 48000;
+    int channelCount = 2;
+    // Polled between decoded chunks so a running file can be abandoned.
+    const std::atomic_bool *cancel = nullptr;
+};
+
+struct TranscodeOutcome {
+    QString outputPath;
+    // True when outputPath was kept: the source itself already had the
+    // requested format, or an earlier run wrote it from this source.
+    bool reused = false;
+    double audioSeconds = 0.0;
+};
+
+// Writes sourcePath as 16-bit PCM WAV with the requested rate and channel
+// count next to the original ("name.wav", or "name_normalized.wav" when that
+// is taken by something else). The output records which source it came
+// from, and only such a file is reused. Audio is streamed through the decoder, so
+// memory use does not grow with the file length.
+bool transcodeToWav(const QString &sourcePath, const TranscodeOptions &options, TranscodeOutcome *outcome,
+                    QString *error = nullptr);
+
+bool isNormalizedWav(const QString &path, int sampleRate, int channelCount);
+// Length of a WAV file from its header alone; 0 when it cannot be read.
+double wavDurationSeconds(const QString &path);
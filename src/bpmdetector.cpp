@@ -0,0 +1,151 @@
+#include "bpmdetector.h"
+
+#include "audiodecode.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int kAnalysisSampleRate = 11025;
+constexpr qint64 kMaxAnalysisMs = 120000;
+constexpr int kFrameSize = 512;
+constexpr int kHopSize = 64;
+constexpr double kMinBpm = 60.0;
+constexpr double kMaxBpm = 200.0;
+constexpr double kPriorBpm = 120.0;
+constexpr double kPriorOctaves = 1.0;
+constexpr double kFullConfidenceSeconds = 30.0;
+
+// Half-wave rectified log-energy flux of a pre-emphasised signal, with a
+// moving average subtracted so slow loudness changes do not read as onsets.
+QVector<float> onsetEnvelope(const QVector<float> &mono) {
+    const int frames = (mono.size() - kFrameSize) / kHopSize + 1;
+    if (frames < 2) {
+        return {};
+    }
+    QVector<float> energy(frames);
+    for (int f = 0; f < frames; ++f) {
+        const float *x = mono.constData() + static_cast<qsizetype>(f) * kHopSize;
+        float sum = 0.0f;
+        float prev = f > 0 ? x[-1] : 0.0f;
+        for (int i = 0; i < kFrameSize; ++i) {
+            const float emphasised = x[i] - 0.97f * prev;
+            prev = x[i];
+            sum += emphasised * emphasised;
+        }
+        energy[f] = std::log1p(1000.0f * sum / kFrameSize);
+    }
+
+    QVector<float> flux(frames, 0.0f);
+    for (int f = 1; f < frames; ++f) {
+        flux[f] = std::max(0.0f, energy[f] - energy[f - 1]);
+    }
+
+    const int radius = std::max(1, kAnalysisSampleRate / kHopSize / 4);
+    QVector<float> envelope(frames, 0.0f);
+    double window = 0.0;
+    int count = 0;
+    for (int f = 0; f < std::min(frames, radius); ++f) {
+        window += flux[f];
+        ++count;
+    }
+    for (int f = 0; f < frames; ++f) {
+        if (f + radius < frames) {
+            window += flux[f + radius];
+            ++count;
+        }
+        if (f - radius - 1 >= 0) {
+            window -= flux[f - radius - 1];
+            --count;
+        }
+        envelope[f] = std::max(0.0f, flux[f] - static_cast<float>(window / std::max(1, count)));
+    }
+    return envelope;
+}
+}
+
+TempoEstimate estimateTempo(const QVector<float> &mono, int sampleRate) {
+    TempoEstimate out;
+    if (sampleRate != kAnalysisSampleRate) {
+        return out;
+    }
+    const QVector<float> envelope = onsetEnvelope(mono);
+    const double framesPerSecond = static_cast<double>(sampleRate) / kHopSize;
+    const int minLag = static_cast<int>(std::floor(60.0 * framesPerSecond / kMaxBpm));
+    const int maxLag = static_cast<int>(std::ceil(60.0 * framesPerSecond / kMinBpm));
+    const int n = envelope.size();
+    const int maxHarmonicLag = maxLag * 2 + 1;
+    if (n <= maxHarmonicLag * 2) {
+        return out;
+    }
+
+    double zeroLag = 0.0;
+    for (int i = 0; i < n; ++i) {
+        zeroLag += static_cast<double>(envelope[i]) * envelope[i];
+    }
+    if (zeroLag <= 0.0) {
+        return out;
+    }
+
+    QVector<double> acf(maxHarmonicLag + 1, 0.0);
+    for (int lag = minLag - 1; lag <= maxHarmonicLag; ++lag) {
+        double sum = 0.0;
+        const float *a = envelope.constData();
+        const float *b = envelope.constData() + lag;
+        for (int i = 0; i < n - lag; ++i) {
+            sum += static_cast<double>(a[i]) * b[i];
+        }
+        acf[lag] = sum / (zeroLag * (n - lag) / n);
+    }
+
+    int bestLag = -1;
+    double bestScore = 0.0;
+    double meanAcf = 0.0;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        const double bpm = 60.0 * framesPerSecond / lag;
+        const double octaves = std::log2(bpm / kPriorBpm) / kPriorOctaves;
+        // The second harmonic breaks ties between the beat and its off-beat subdivisions.
+        const double score = (acf[lag] + 0.5 * acf[lag * 2]) * std::exp(-0.5 * octaves * octaves);
+        meanAcf += acf[lag];
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+    meanAcf /= (maxLag - minLag + 1);
+    if (bestLag < 0) {
+        return out;
+    }
+
+    const double left = acf[bestLag - 1];
+    const double mid = acf[bestLag];
+    const double right = acf[bestLag + 1];
+    const double denom = left - 2.0 * mid + right;
+    const double offset = std::abs(denom) > 1e-12 ? std::clamp(0.5 * (left - right) / denom, -0.5, 0.5) : 0.0;
+    out.bpm = 60.0 * framesPerSecond / (bestLag + offset);
+
+    const double seconds = static_cast<double>(mono.size()) / sampleRate;
+    const double prominence = mid > 0.0 ? std::clamp((mid - meanAcf) / mid, 0.0, 1.0) : 0.0;
+    out.confidence = prominence * std::min(1.0, seconds / kFullConfidenceSeconds);
+    return out;
+}
+
+bool detectTempo(const QString &audioPath, TempoEstimate *estimate, QString *error) {
+    AudioDecodeOptions options;
+    options.sampleRate = kAnalysisSampleRate;
+    options.channelCount = 1;
+    options.maxDurationMs = kMaxAnalysisMs;
+    QVector<float> mono;
+    AudioStreamInfo info;
+    if (!decodeAudioFile(audioPath, options, &mono, &info, error)) {
+        return false;
+    }
+    *estimate = estimateTempo(mono, info.sampleRate);
+    if (estimate->bpm <= 0.0) {
+        if (error) {
+            *error = QStringLiteral("No steady pulse found");
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct TempoEstimate {
+    double bpm = 0.0;
+    double confidence = 0.0;
+};
+
+TempoEstimate estimateTempo(const QVector<float> &mono, int sampleRate);
+bool detectTempo(const QString &audioPath, TempoEstimate *estimate, QString *error = nullptr);
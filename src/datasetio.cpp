@@ -0,0 +1,318 @@
+#include "datasetio.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+// A key with its value already encoded as JSON, in output order.
+struct JsonField {
+    QString key;
+    QString value;
+};
+
+QString formatDateTimeMicros(const QDateTime &dt) {
+    const QDateTime local = dt.toLocalTime();
+    const QString base = local.toString("yyyy-MM-ddTHH:mm:ss");
+    const int micros = local.time().msec() * 1000;
+    const QString frac = QString("%1").arg(micros, 6, 10, QChar('0'));
+    return base + "." + frac;
+}
+
+QString jsonQuoted(const QString &value) {
+    QJsonArray arr;
+    arr.append(value);
+    const QString compact = QString::fromUtf8(QJsonDocument(arr).toJson(QJsonDocument::Compact));
+    return compact.mid(1, compact.size() - 2);
+}
+
+QString jsonBool(bool value) {
+    return value ? QStringLiteral("true") : QStringLiteral("false");
+}
+
+QList<JsonField> metadataFields(const DatasetMetadata &meta, int sampleCount) {
+    return {
+        {"name", jsonQuoted(meta.name)},
+        {"custom_tag", jsonQuoted(meta.customTag)},
+        {"tag_position", jsonQuoted(meta.tagPosition)},
+        {"created_at", jsonQuoted(formatDateTimeMicros(meta.createdAt))},
+        {"num_samples", QString::number(sampleCount)},
+        {"all_instrumental", jsonBool(meta.allInstrumental)},
+        {"genre_ratio", QString::number(meta.genreRatio)},
+    };
+}
+
+QList<JsonField> sampleFields(const DatasetMetadata &meta, const TrackData &t) {
+    const QString promptOverride = t.promptOverride.trimmed().toLower();
+    return {
+        {"id", jsonQuoted(t.id)},
+        {"audio_path", jsonQuoted(QDir::toNativeSeparators(t.audioPath))},
+        {"filename", jsonQuoted(t.filename)},
+        {"caption", jsonQuoted(t.caption)},
+        {"genre", jsonQuoted(t.genre)},
+        {"lyrics", jsonQuoted(t.lyrics)},
+        {"raw_lyrics", jsonQuoted(QString(""))},
+        {"formatted_lyrics", jsonQuoted(t.lyrics)},
+        {"bpm", QString::number(t.bpm)},
+        {"keyscale", jsonQuoted(t.keyscale)},
+        {"timesignature", jsonQuoted(t.timesignature)},
+        {"duration", QString::number(t.duration)},
+        {"language", jsonQuoted(t.language)},
+        {"is_instrumental", jsonBool(t.isInstrumental)},
+        {"custom_tag", jsonQuoted(meta.customTag)},
+        {"labeled", jsonBool(!t.caption.trimmed().isEmpty())},
+        {"prompt_override", promptOverride.isEmpty() ? QStringLiteral("null") : jsonQuoted(promptOverride)},
+    };
+}
+
+void appendIndented(QString &out, int indent, const QList<JsonField> &fields) {
+    for (int i = 0; i < fields.size(); ++i) {
+        out += QString(indent, ' ') + jsonQuoted(fields[i].key) + ": " + fields[i].value;
+        out += i + 1 < fields.size() ? ",\n" : "\n";
+    }
+}
+
+QByteArray compactLine(const QList<JsonField> &fields) {
+    QString out = QStringLiteral("{");
+    for (int i = 0; i < fields.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += jsonQuoted(fields[i].key) + ':' + fields[i].value;
+    }
+    out += QStringLiteral("}\n");
+    return out.toUtf8();
+}
+
+DatasetMetadata metadataFromJson(const QJsonObject &meta) {
+    DatasetMetadata out;
+    out.name = meta.value("name").toString("Dataset");
+    out.customTag = meta.value("custom_tag").toString();
+    out.tagPosition = sanitizeTagPosition(meta.value("tag_position").toString("prepend"));
+    out.createdAt = QDateTime::fromString(meta.value("created_at").toString(), Qt::ISODate);
+    if (!out.createdAt.isValid()) {
+        out.createdAt = QDateTime::currentDateTimeUtc();
+    }
+    out.allInstrumental = meta.value("all_instrumental").toBool(false);
+    out.genreRatio = meta.value("genre_ratio").toInt(0);
+    return out;
+}
+
+TrackData trackFromJson(const QJsonObject &s, const QString &folderPath) {
+    TrackData t;
+    t.id = s.value("id").toString();
+    t.audioPath = s.value("audio_path").toString();
+    t.filename = s.value("filename").toString(QFileInfo(t.audioPath).fileName());
+    t.caption = s.value("caption").toString();
+    t.genre = s.value("genre").toString();
+    t.lyrics = s.value("lyrics").toString();
+    t.bpm = s.value("bpm").toInt();
+    t.keyscale = s.value("keyscale").toString();
+    t.timesignature = s.value("timesignature").toString();
+    t.duration = s.value("duration").toInt();
+    t.language = s.value("language").toString("instrumental");
+    t.isInstrumental = s.value("is_instrumental").toBool(false);
+    t.customTag = s.value("custom_tag").toString();
+    t.labeled = s.value("labeled").toBool(false);
+    if (s.contains("prompt_override") && !s.value("prompt_override").isNull()) {
+        const QString po = s.value("prompt_override").toString().trimmed().toLower();
+        if (po == "caption" || po == "genre") {
+            t.promptOverride = po;
+        }
+    }
+    if (t.id.isEmpty()) {
+        t.id = generateTrackId(t.audioPath.isEmpty() ? t.filename : t.audioPath);
+    }
+    if (t.audioPath.isEmpty() && !t.filename.isEmpty()) {
+        t.audioPath = QDir(folderPath).filePath(t.filename);
+    }
+    return t;
+}
+}
+
+QString generateTrackId(const QString &source) {
+    const QByteArray hash = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QString::fromLatin1(hash.left(8));
+}
+
+QString sanitizeTagPosition(const QString &value) {
+    if (value == "append" || value == "prepend") {
+        return value;
+    }
+    if (value == "replace_caption" || value == "replace") {
+        return "replace";
+    }
+    return "prepend";
+}
+
+bool isJsonlPath(const QString &path) {
+    return path.endsWith(QStringLiteral(".jsonl"), Qt::CaseInsensitive);
+}
+
+QStringList audioFileFilters() {
+    return {"*.mp3", "*.wav", "*.flac", "*.m4a", "*.ogg", "*.aac"};
+}
+
+QByteArray buildOrderedJson(const DatasetMetadata &meta, const QList<TrackData> &tracks) {
+    QString out;
+    out += "{\n";
+    out += "  \"metadata\": {\n";
+    appendIndented(out, 4, metadataFields(meta, static_cast<int>(tracks.size())));
+    out += "  },\n";
+    out += "  \"samples\": [\n";
+
+    for (int i = 0; i < tracks.size(); ++i) {
+        out += "    {\n";
+        appendIndented(out, 6, sampleFields(meta, tracks[i]));
+        out += (i + 1 < tracks.size()) ? "    },\n" : "    }\n";
+    }
+
+    out += "  ]\n";
+    out += "}\n";
+    return out.toUtf8();
+}
+
+bool readDatasetSamples(const QString &path, const QString &folderPath, DatasetMetadata *meta,
+                        const DatasetSampleSink &sink, QString *error) {
+    if (isJsonlPath(path)) {
+        return readDatasetJsonl(path, folderPath, meta, sink, error);
+    }
+    // The .json format has to be parsed whole; only the samples are handed
+    // over one at a time.
+    QFile f(path);
+    QJsonParseError err;
+    const QJsonDocument doc =
+        f.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(f.readAll(), &err) : QJsonDocument();
+    f.close();
+    if (doc.isNull() || !doc.isObject()) {
+        if (error) {
+            *error = QStringLiteral("Not a readable dataset JSON file");
+        }
+        return false;
+    }
+
+    const QJsonObject root = doc.object();
+    *meta = metadataFromJson(root.value("metadata").toObject());
+    const QJsonArray samples = root.value("samples").toArray();
+    for (const QJsonValue &v : samples) {
+        if (!sink(trackFromJson(v.toObject(), folderPath))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readDatasetFile(const QString &path, const QString &folderPath, LoadedDataset *out, QString *error) {
+    out->jsonPath = path;
+    out->tracks.clear();
+    return readDatasetSamples(
+        path, folderPath, &out->meta,
+        [out](const TrackData &track) {
+            out->tracks.append(track);
+            return true;
+        },
+        error);
+}
+
+bool writeDatasetTracks(const QString &path, const DatasetMetadata &meta, const QList<TrackData> &tracks,
+                        QString *error) {
+    if (isJsonlPath(path)) {
+        JsonlDatasetWriter writer;
+        if (!writer.open(path, meta, static_cast<int>(tracks.size()), error)) {
+            return false;
+        }
+        for (const TrackData &track : tracks) {
+            if (!writer.write(track)) {
+                break;
+            }
+        }
+        return writer.commit(error);
+    }
+    QSaveFile file(path);
+    const QByteArray bytes = buildOrderedJson(meta, tracks);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool JsonlDatasetWriter::open(const QString &path, const DatasetMetadata &meta, int sampleCount, QString *error) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = m_file.errorString();
+        }
+        return false;
+    }
+    m_meta = meta;
+    const QByteArray header =
+        "{\"metadata\":" + compactLine(metadataFields(meta, sampleCount)).chopped(1) + "}\n";
+    return m_file.write(header) == header.size();
+}
+
+bool JsonlDatasetWriter::write(const TrackData &track) {
+    const QByteArray line = compactLine(sampleFields(m_meta, track));
+    return m_file.write(line) == line.size();
+}
+
+bool JsonlDatasetWriter::commit(QString *error) {
+    if (!m_file.commit()) {
+        if (error) {
+            *error = m_file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool readDatasetJsonl(const QString &path, const QString &folderPath, DatasetMetadata *meta,
+                      const DatasetSampleSink &sink, QString *error) {
+    const auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return fail(f.errorString());
+    }
+    *meta = DatasetMetadata{};
+    bool first = true;
+    int lineNumber = 0;
+    while (!f.atEnd()) {
+        const QByteArray line = f.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError err;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+        if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+            return fail(QStringLiteral("Line %1: %2")
+                            .arg(lineNumber)
+                            .arg(err.error != QJsonParseError::NoError ? err.errorString()
+                                                                       : QStringLiteral("not a JSON object")));
+        }
+        const QJsonObject object = doc.object();
+        // A file cut from the middle of a shard has no header; it still
+        // reads, with default metadata.
+        if (first && object.contains("metadata")) {
+            first = false;
+            *meta = metadataFromJson(object.value("metadata").toObject());
+            continue;
+        }
+        first = false;
+        if (!sink(trackFromJson(object, folderPath))) {
+            return false;
+        }
+    }
+    return true;
+}
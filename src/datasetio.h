@@ -0,0 +1,64 @@
+#pragma once
+
+#include "audioitemwidget.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+struct DatasetMetadata {
+    QString name = "Dataset";
+    QString customTag;
+    QString tagPosition = "prepend";
+    QDateTime createdAt = QDateTime::currentDateTimeUtc();
+    bool allInstrumental = false;
+    int genreRatio = 0;
+};
+
+struct LoadedDataset {
+    // Empty when the tracks were listed from the audio files in the folder.
+    QString jsonPath;
+    DatasetMetadata meta;
+    QList<TrackData> tracks;
+};
+
+QString generateTrackId(const QString &source);
+QString sanitizeTagPosition(const QString &value);
+bool isJsonlPath(const QString &path);
+// Name filters for the audio files a dataset folder is listed from.
+QStringList audioFileFilters();
+
+// The monolithic .json format: {"metadata": {...}, "samples": [...]}.
+QByteArray buildOrderedJson(const DatasetMetadata &meta, const QList<TrackData> &tracks);
+// These pick .json or .jsonl from the file name.
+bool readDatasetFile(const QString &path, const QString &folderPath, LoadedDataset *out, QString *error = nullptr);
+bool writeDatasetTracks(const QString &path, const DatasetMetadata &meta, const QList<TrackData> &tracks,
+                        QString *error = nullptr);
+
+// JSON Lines: a {"metadata": {...}} header line followed by one sample per
+// line, each with exactly the fields of a "samples" entry in the .json
+// format, so the two convert into each other without loss. Samples are
+// written and read one at a time.
+class JsonlDatasetWriter {
+public:
+    bool open(const QString &path, const DatasetMetadata &meta, int sampleCount, QString *error = nullptr);
+    bool write(const TrackData &track);
+    bool commit(QString *error = nullptr);
+
+private:
+    QSaveFile m_file;
+    DatasetMetadata m_meta;
+};
+
+using DatasetSampleSink = std::function<bool(const TrackData &track)>;
+// Calls sink for every sample in file order; a false return stops reading.
+bool readDatasetJsonl(const QString &path, const QString &folderPath, DatasetMetadata *meta,
+                      const DatasetSampleSink &sink, QString *error = nullptr);
+// readDatasetJsonl for either format.
+bool readDatasetSamples(const QString &path, const QString &folderPath, DatasetMetadata *meta,
+                        const DatasetSampleSink &sink, QString *error = nullptr);
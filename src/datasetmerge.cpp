@@ -0,0 +1,129 @@
+#include "datasetmerge.h"
+
+#include "trackedits.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+
+namespace {
+QString mergeKeyOf(const TrackData &track, MergeKey key) {
+    if (key == MergeKey::Id) {
+        return track.id;
+    }
+    const QString path = QDir::cleanPath(QDir::fromNativeSeparators(track.audioPath));
+#ifdef Q_OS_WIN
+    return path.toLower();
+#else
+    return path;
+#endif
+}
+
+bool hasConflict(const TrackData &kept, const TrackData &other) {
+    for (const QString &field : undoableTrackFields()) {
+        if (trackFieldValue(kept, field) != trackFieldValue(other, field)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void fillEmptyFields(TrackData &into, const TrackData &from) {
+    const auto fill = [](QString &value, const QString &other) {
+        if (value.trimmed().isEmpty()) {
+            value = other;
+        }
+    };
+    fill(into.caption, from.caption);
+    fill(into.genre, from.genre);
+    fill(into.lyrics, from.lyrics);
+    fill(into.keyscale, from.keyscale);
+    fill(into.timesignature, from.timesignature);
+    fill(into.promptOverride, from.promptOverride);
+    if (into.bpm <= 0) {
+        into.bpm = from.bpm;
+    }
+    if (into.duration <= 0) {
+        into.duration = from.duration;
+    }
+}
+}
+
+bool mergeDatasets(const DatasetMergeOptions &options, DatasetMergeSummary *summary, QString *error) {
+    *summary = DatasetMergeSummary{};
+    DatasetMetadata outputMeta;
+    QList<TrackData> merged;
+    QHash<QString, int> index;
+    for (int i = 0; i < options.inputs.size(); ++i) {
+        const QString &input = options.inputs[i];
+        const QDir folder = QFileInfo(input).absoluteDir();
+        DatasetMetadata meta;
+        QString message;
+        const bool ok = readDatasetSamples(
+            input, folder.absolutePath(), &meta,
+            [&](const TrackData &sample) {
+                TrackData track = sample;
+                if (!track.audioPath.isEmpty() && QFileInfo(track.audioPath).isRelative()) {
+                    // An id made from the relative path (because the sample had none)
+                    // would match a file named alike in another input's folder.
+                    if (track.id == generateTrackId(track.audioPath)) {
+                        track.id = generateTrackId(folder.absoluteFilePath(track.audioPath));
+                    }
+                    track.audioPath = folder.absoluteFilePath(track.audioPath);
+                } else if (!track.filename.isEmpty() && track.id == generateTrackId(track.filename)) {
+                    track.id = generateTrackId(QFileInfo(track.audioPath).absoluteFilePath());
+                }
+                ++summary->inputSamples;
+                const QString key = mergeKeyOf(track, options.key);
+                const auto it = index.constFind(key);
+                if (it == index.cend()) {
+                    index.insert(key, static_cast<int>(merged.size()));
+                    merged.append(track);
+                    return true;
+                }
+                ++summary->duplicates;
+                TrackData &kept = merged[*it];
+                if (!hasConflict(kept, track)) {
+                    return true;
+                }
+                ++summary->conflicts;
+                if (options.policy == MergeConflictPolicy::KeepLast) {
+                    kept = track;
+                } else if (options.policy == MergeConflictPolicy::FillEmpty) {
+                    fillEmptyFields(kept, track);
+                }
+                return true;
+            },
+            &message);
+        if (!ok) {
+            if (error) {
+                *error = QStringLiteral("%1: %2").arg(QFileInfo(input).fileName(), message);
+            }
+            return false;
+        }
+        if (i == 0) {
+            outputMeta = meta;
+        } else if (meta.customTag != outputMeta.customTag) {
+            // The tag is dataset-wide and written into every sample, so
+            // merging would silently retag the later inputs.
+            if (error) {
+                *error = QStringLiteral("%1 has custom tag \"%2\" but %3 has \"%4\"")
+                             .arg(QFileInfo(input).fileName(), meta.customTag,
+                                  QFileInfo(options.inputs.first()).fileName(), outputMeta.customTag);
+            }
+            return false;
+        }
+    }
+    if (merged.isEmpty()) {
+        if (error) {
+            *error = QStringLiteral("The inputs contain no samples");
+        }
+        return false;
+    }
+    outputMeta.createdAt = QDateTime::currentDateTime();
+    if (!writeDatasetTracks(options.outputPath, outputMeta, merged, error)) {
+        return false;
+    }
+    summary->written = static_cast<int>(merged.size());
+    return true;
+}
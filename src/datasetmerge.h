@@ -0,0 +1,39 @@
+#pragma once
+
+#include "datasetio.h"
+
+#include <QString>
+#include <QStringList>
+
+enum class MergeKey {
+    Id,
+    AudioPath,
+};
+
+enum class MergeConflictPolicy {
+    KeepFirst,
+    KeepLast,
+    // Keep the first sample and fill its empty fields from later duplicates.
+    FillEmpty,
+};
+
+struct DatasetMergeOptions {
+    QStringList inputs;
+    QString outputPath;
+    MergeKey key = MergeKey::Id;
+    MergeConflictPolicy policy = MergeConflictPolicy::FillEmpty;
+};
+
+struct DatasetMergeSummary {
+    int inputSamples = 0;
+    int written = 0;
+    int duplicates = 0;
+    // Duplicates whose editable fields differed from the kept sample.
+    int conflicts = 0;
+};
+
+// Reads the inputs one sample at a time into a hash index on the merge key
+// and writes the merged samples in first-seen order. Metadata comes from the
+// first input; inputs whose custom tag differs from it are refused. Relative audio paths are resolved against their own input's
+// folder so they stay valid in the merged file.
+bool mergeDatasets(const DatasetMergeOptions &options, DatasetMergeSummary *summary, QString *error = nullptr);
@@ -0,0 +1,103 @@
+#include "fft.h"
+
+#include <cmath>
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586;
+}
+
+RealFft::RealFft(int size) : m_size(size), m_half(size / 2) {
+    Q_ASSERT(size >= 4 && (size & (size - 1)) == 0);
+
+    int bits = 0;
+    while ((1 << bits) < m_half) {
+        ++bits;
+    }
+    m_bitReverse.resize(m_half);
+    for (int i = 0; i < m_half; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+
+    for (int len = 2; len <= m_half; len *= 2) {
+        QVector<float> c(len / 2);
+        QVector<float> s(len / 2);
+        for (int j = 0; j < len / 2; ++j) {
+            const double angle = -kTwoPi * j / len;
+            c[j] = static_cast<float>(std::cos(angle));
+            s[j] = static_cast<float>(std::sin(angle));
+        }
+        m_stageCos.append(c);
+        m_stageSin.append(s);
+    }
+
+    m_postCos.resize(m_half + 1);
+    m_postSin.resize(m_half + 1);
+    for (int k = 0; k <= m_half; ++k) {
+        const double angle = kTwoPi * k / m_size;
+        m_postCos[k] = static_cast<float>(std::cos(angle));
+        m_postSin[k] = static_cast<float>(std::sin(angle));
+    }
+
+    m_window.resize(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(kTwoPi * i / m_size));
+    }
+    m_re.resize(m_half);
+    m_im.resize(m_half);
+}
+
+void RealFft::powerSpectrum(const float *input, float *power) {
+    // Pack even/odd samples as one half-length complex signal.
+    float *re = m_re.data();
+    float *im = m_im.data();
+    const float *window = m_window.constData();
+    for (int i = 0; i < m_half; ++i) {
+        const int r = m_bitReverse[i];
+        re[r] = input[2 * i] * window[2 * i];
+        im[r] = input[2 * i + 1] * window[2 * i + 1];
+    }
+    transform();
+
+    for (int k = 0; k <= m_half; ++k) {
+        const int a = k % m_half;
+        const int b = (m_half - k) % m_half;
+        const float evenRe = 0.5f * (re[a] + re[b]);
+        const float evenIm = 0.5f * (im[a] - im[b]);
+        const float oddRe = 0.5f * (im[a] + im[b]);
+        const float oddIm = -0.5f * (re[a] - re[b]);
+        const float c = m_postCos[k];
+        const float s = m_postSin[k];
+        const float outRe = evenRe + c * oddRe + s * oddIm;
+        const float outIm = evenIm + c * oddIm - s * oddRe;
+        power[k] = outRe * outRe + outIm * outIm;
+    }
+}
+
+void RealFft::transform() {
+    float *re = m_re.data();
+    float *im = m_im.data();
+    int stage = 0;
+    for (int len = 2; len <= m_half; len *= 2, ++stage) {
+        const int half = len / 2;
+        const float *wc = m_stageCos[stage].constData();
+        const float *ws = m_stageSin[stage].constData();
+        for (int base = 0; base < m_half; base += len) {
+            float *ur = re + base;
+            float *ui = im + base;
+            float *vr = re + base + half;
+            float *vi = im + base + half;
+            for (int j = 0; j < half; ++j) {
+                const float tr = vr[j] * wc[j] - vi[j] * ws[j];
+                const float ti = vr[j] * ws[j] + vi[j] * wc[j];
+                vr[j] = ur[j] - tr;
+                vi[j] = ui[j] - ti;
+                ur[j] += tr;
+                ui[j] += ti;
+            }
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QVector>
+
+// Real-input FFT for a fixed power-of-two size. Data is kept in split
+// real/imaginary arrays and every butterfly stage walks contiguous twiddle
+// tables, so the inner loops vectorise without intrinsics.
+class RealFft {
+public:
+    explicit RealFft(int size);
+
+    int size() const { return m_size; }
+    int binCount() const { return m_size / 2 + 1; }
+
+    // Applies a Hann window to size() samples and writes binCount() power values.
+    void powerSpectrum(const float *input, float *power);
+
+private:
+    void transform();
+
+    int m_size = 0;
+    int m_half = 0;
+    QVector<int> m_bitReverse;
+    QVector<QVector<float>> m_stageCos;
+    QVector<QVector<float>> m_stageSin;
+    QVector<float> m_postCos;
+    QVector<float> m_postSin;
+    QVector<float> m_window;
+    QVector<float> m_re;
+    QVector<float> m_im;
+};
@@ -0,0 +1,101 @@
+#include "findreplace.h"
+#include "trackedits.h"
+
+#include <QRegularExpression>
+#include <QVector>
+#include <QtConcurrent>
+
+namespace {
+constexpr int kChunkRows = 256;
+
+struct RowRange {
+    int begin = 0;
+    int end = 0;
+};
+
+QList<FindReplaceChange> processChunk(const QList<TrackData> &tracks, const FindReplaceOptions &options,
+                                      const RowRange &range) {
+    QList<FindReplaceChange> out;
+    const Qt::CaseSensitivity cs = options.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    QRegularExpression re;
+    if (options.useRegex) {
+        re.setPattern(options.pattern);
+        if (!options.caseSensitive) {
+            re.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        }
+    }
+
+    for (int row = range.begin; row < range.end; ++row) {
+        for (const QString &field : options.fields) {
+            const QString before = trackFieldValue(tracks[row], field);
+            if (before.isEmpty()) {
+                continue;
+            }
+            int matches = 0;
+            QString after = before;
+            if (options.useRegex) {
+                QRegularExpressionMatchIterator it = re.globalMatch(before);
+                while (it.hasNext()) {
+                    it.next();
+                    ++matches;
+                }
+                if (matches > 0) {
+                    after.replace(re, options.replacement);
+                }
+            } else {
+                // Counted the way replace() walks the text: each match
+                // resumes after the previous one, so overlaps count once.
+                for (qsizetype at = before.indexOf(options.pattern, 0, cs); at >= 0;
+                     at = before.indexOf(options.pattern, at + options.pattern.size(), cs)) {
+                    ++matches;
+                }
+                if (matches > 0) {
+                    after.replace(options.pattern, options.replacement, cs);
+                }
+            }
+            if (matches > 0 && after != before) {
+                out.append({row, field, before, after, matches});
+            }
+        }
+    }
+    return out;
+}
+}
+
+QStringList findReplaceTextFields() {
+    return {"caption", "lyrics", "genre", "keyscale", "timesignature"};
+}
+
+FindReplaceResult computeFindReplace(const QList<TrackData> &tracks, const FindReplaceOptions &options) {
+    FindReplaceResult result;
+    if (options.pattern.isEmpty() || options.fields.isEmpty()) {
+        return result;
+    }
+    if (options.useRegex) {
+        const QRegularExpression probe(options.pattern);
+        if (!probe.isValid()) {
+            result.error = probe.errorString();
+            return result;
+        }
+    }
+
+    QVector<RowRange> ranges;
+    for (int begin = 0; begin < tracks.size(); begin += kChunkRows) {
+        ranges.append({begin, qMin(begin + kChunkRows, static_cast<int>(tracks.size()))});
+    }
+    const QList<QList<FindReplaceChange>> chunks = QtConcurrent::blockingMapped<QList<QList<FindReplaceChange>>>(
+        ranges, [&tracks, &options](const RowRange &range) { return processChunk(tracks, options, range); });
+
+    int lastRow = -1;
+    for (const QList<FindReplaceChange> &chunk : chunks) {
+        for (const FindReplaceChange &change : chunk) {
+            result.matchCount += change.matches;
+            if (change.row != lastRow) {
+                ++result.trackCount;
+                lastRow = change.row;
+            }
+            result.changes.append(change);
+        }
+    }
+    return result;
+}
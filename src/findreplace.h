@@ -0,0 +1,33 @@
+#pragma once
+
+#include "audioitemwidget.h"
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+struct FindReplaceOptions {
+    QStringList fields;
+    QString pattern;
+    QString replacement;
+    bool useRegex = false;
+    bool caseSensitive = false;
+};
+
+struct FindReplaceChange {
+    int row = -1;
+    QString field;
+    QString before;
+    QString after;
+    int matches = 0;
+};
+
+struct FindReplaceResult {
+    QList<FindReplaceChange> changes;
+    int matchCount = 0;
+    int trackCount = 0;
+    QString error;
+};
+
+QStringList findReplaceTextFields();
+FindReplaceResult computeFindReplace(const QList<TrackData> &tracks, const FindReplaceOptions &options);
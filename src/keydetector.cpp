@@ -0,0 +1,138 @@
+#include "keydetector.h"
+
+#include "audiodecode.h"
+#include "fft.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+constexpr int kAnalysisSampleRate = 11025;
+constexpr qint64 kMaxAnalysisMs = 180000;
+constexpr int kFrameSize = 4096;
+constexpr double kMinFrequency = 65.0;
+constexpr double kMaxFrequency = 2100.0;
+constexpr double kDecisiveMargin = 0.08;
+
+using Chroma = std::array<double, 12>;
+
+// Krumhansl-Kessler probe-tone profiles, tonic first.
+constexpr Chroma kMajorProfile = {6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88};
+constexpr Chroma kMinorProfile = {6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17};
+
+const char *const kPitchNames[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+double correlate(const Chroma &chroma, const Chroma &profile, int tonic) {
+    double meanC = 0.0;
+    double meanP = 0.0;
+    for (int i = 0; i < 12; ++i) {
+        meanC += chroma[i];
+        meanP += profile[i];
+    }
+    meanC /= 12.0;
+    meanP /= 12.0;
+    double num = 0.0;
+    double varC = 0.0;
+    double varP = 0.0;
+    for (int i = 0; i < 12; ++i) {
+        const double c = chroma[(tonic + i) % 12] - meanC;
+        const double p = profile[i] - meanP;
+        num += c * p;
+        varC += c * c;
+        varP += p * p;
+    }
+    return varC > 0.0 ? num / std::sqrt(varC * varP) : 0.0;
+}
+}
+
+KeyEstimate estimateKey(const QVector<float> &mono, int sampleRate) {
+    KeyEstimate out;
+    if (sampleRate <= 0 || mono.size() < kFrameSize) {
+        return out;
+    }
+
+    RealFft fft(kFrameSize);
+    QVector<int> binClass(fft.binCount(), -1);
+    Chroma binsPerClass{};
+    for (int k = 1; k < fft.binCount(); ++k) {
+        const double freq = static_cast<double>(k) * sampleRate / kFrameSize;
+        if (freq < kMinFrequency || freq > kMaxFrequency) {
+            continue;
+        }
+        const int midi = static_cast<int>(std::lround(69.0 + 12.0 * std::log2(freq / 440.0)));
+        binClass[k] = ((midi % 12) + 12) % 12;
+        binsPerClass[binClass[k]] += 1.0;
+    }
+
+    Chroma total{};
+    QVector<float> power(fft.binCount());
+    for (qsizetype start = 0; start + kFrameSize <= mono.size(); start += kFrameSize) {
+        fft.powerSpectrum(mono.constData() + start, power.data());
+        Chroma frame{};
+        for (int k = 0; k < power.size(); ++k) {
+            if (binClass[k] >= 0) {
+                frame[binClass[k]] += std::sqrt(power[k]);
+            }
+        }
+        // Higher pitch classes own more bins; without this noise looks tonal.
+        for (int i = 0; i < 12; ++i) {
+            frame[i] /= std::max(1.0, binsPerClass[i]);
+        }
+        // Normalising per frame stops a few loud bars from deciding the key.
+        const double peak = *std::max_element(frame.begin(), frame.end());
+        if (peak <= 1e-3) {
+            continue;
+        }
+        for (int i = 0; i < 12; ++i) {
+            total[i] += frame[i] / peak;
+        }
+    }
+
+    double best = -2.0;
+    double second = -2.0;
+    for (int tonic = 0; tonic < 12; ++tonic) {
+        for (int mode = 0; mode < 2; ++mode) {
+            const double r = correlate(total, mode == 0 ? kMajorProfile : kMinorProfile, tonic);
+            if (r > best) {
+                second = best;
+                best = r;
+                out.keyscale = QStringLiteral("%1 %2").arg(QLatin1String(kPitchNames[tonic]),
+                                                           mode == 0 ? QStringLiteral("major")
+                                                                     : QStringLiteral("minor"));
+            } else if (r > second) {
+                second = r;
+            }
+        }
+    }
+    if (best <= 0.0) {
+        out.keyscale.clear();
+        return out;
+    }
+    const double peak = *std::max_element(total.begin(), total.end());
+    const double trough = *std::min_element(total.begin(), total.end());
+    const double contrast = peak > 0.0 ? std::clamp(2.0 * (peak - trough) / peak, 0.0, 1.0) : 0.0;
+    out.confidence = std::clamp(best, 0.0, 1.0) * std::clamp((best - second) / kDecisiveMargin, 0.0, 1.0) *
+                     contrast;
+    return out;
+}
+
+bool detectKey(const QString &audioPath, KeyEstimate *estimate, QString *error) {
+    AudioDecodeOptions options;
+    options.sampleRate = kAnalysisSampleRate;
+    options.channelCount = 1;
+    options.maxDurationMs = kMaxAnalysisMs;
+    QVector<float> mono;
+    AudioStreamInfo info;
+    if (!decodeAudioFile(audioPath, options, &mono, &info, error)) {
+        return false;
+    }
+    *estimate = estimateKey(mono, info.sampleRate);
+    if (estimate->keyscale.isEmpty()) {
+        if (error) {
+            *error = QStringLiteral("No tonal content found");
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct KeyEstimate {
+    QString keyscale;
+    double confidence = 0.0;
+};
+
+KeyEstimate estimateKey(const QVector<float> &mono, int sampleRate);
+bool detectKey(const QString &audioPath, KeyEstimate *estimate, QString *error = nullptr);
@@ -0,0 +1,378 @@
+#include "loudnessanalyzer.h"
+
+#include "audiodecode.h"
+
+#include <QVector>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace {
+constexpr int kMaxChannels = 2;
+constexpr double kAbsoluteGateLufs = -70.0;
+constexpr double kRelativeGateLu = -10.0;
+constexpr int kSubBlocksPerBlock = 4;
+constexpr int kOversample = 4;
+constexpr int kTapsPerPhase = 12;
+constexpr float kClipLevel = 0.999f;
+constexpr float kSilenceLevel = 0.001f;
+constexpr double kSilenceWindowSec = 0.01;
+constexpr double kNoiseFloorDb = -120.0;
+constexpr double kPi = 3.141592653589793;
+
+constexpr double kLongSilenceSec = 2.0;
+constexpr double kQuietLufs = -30.0;
+
+double energyToLufs(double energy) {
+    return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -std::numeric_limits<double>::infinity();
+}
+
+double amplitudeToDb(double amplitude) {
+    return amplitude > 0.0 ? std::max(kNoiseFloorDb, 20.0 * std::log10(amplitude)) : kNoiseFloorDb;
+}
+
+struct Biquad {
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    double z1 = 0.0, z2 = 0.0;
+
+    void process(float *x, qsizetype n) {
+        for (qsizetype i = 0; i < n; ++i) {
+            const double in = x[i];
+            const double out = b0 * in + z1;
+            z1 = b1 * in - a1 * out + z2;
+            z2 = b2 * in - a2 * out;
+            x[i] = static_cast<float>(out);
+        }
+    }
+};
+
+// BS.1770 K-weighting, re-derived for the actual sample rate rather than
+// using the 48 kHz coefficient table from the spec.
+std::array<Biquad, 2> kWeightingFilters(int sampleRate) {
+    std::array<Biquad, 2> filters;
+
+    double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(kPi * f0 / sampleRate);
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    filters[0].b0 = (vh + vb * k / q + k * k) / a0;
+    filters[0].b1 = 2.0 * (k * k - vh) / a0;
+    filters[0].b2 = (vh - vb * k / q + k * k) / a0;
+    filters[0].a1 = 2.0 * (k * k - 1.0) / a0;
+    filters[0].a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(kPi * f0 / sampleRate);
+    a0 = 1.0 + k / q + k * k;
+    filters[1].b0 = 1.0;
+    filters[1].b1 = -2.0;
+    filters[1].b2 = 1.0;
+    filters[1].a1 = 2.0 * (k * k - 1.0) / a0;
+    filters[1].a2 = (1.0 - k / q + k * k) / a0;
+    return filters;
+}
+
+// Windowed-sinc interpolator split into phases. Taps are stored reversed so
+// each output is a forward dot product over contiguous input.
+std::array<std::array<float, kTapsPerPhase>, kOversample> truePeakPhases() {
+    constexpr int length = kOversample * kTapsPerPhase;
+    std::array<double, length> taps{};
+    for (int n = 0; n < length; ++n) {
+        const double t = (n - (length - 1) / 2.0) / kOversample;
+        const double sinc = t == 0.0 ? 1.0 : std::sin(kPi * t) / (kPi * t);
+        const double w = 0.42 - 0.5 * std::cos(2.0 * kPi * n / (length - 1)) +
+                         0.08 * std::cos(4.0 * kPi * n / (length - 1));
+        taps[n] = sinc * w;
+    }
+    std::array<std::array<float, kTapsPerPhase>, kOversample> phases{};
+    for (int p = 0; p < kOversample; ++p) {
+        double sum = 0.0;
+        for (int j = 0; j < kTapsPerPhase; ++j) {
+            sum += taps[p + kOversample * j];
+        }
+        for (int j = 0; j < kTapsPerPhase; ++j) {
+            phases[p][j] = static_cast<float>(taps[p + kOversample * (kTapsPerPhase - 1 - j)] / sum);
+        }
+    }
+    return phases;
+}
+
+class LoudnessMeter {
+public:
+    LoudnessMeter(int sampleRate, int channels)
+        : m_sampleRate(sampleRate),
+          m_channels(std::clamp(channels, 1, kMaxChannels)),
+          m_subBlockFrames(std::max(1, sampleRate / 10)),
+          m_silenceWindowFrames(std::max(1, static_cast<int>(sampleRate * kSilenceWindowSec))),
+          m_phases(truePeakPhases()) {
+        for (int c = 0; c < m_channels; ++c) {
+            m_filters[c] = kWeightingFilters(sampleRate);
+            m_history[c] = QVector<float>(kTapsPerPhase - 1, 0.0f);
+        }
+    }
+
+    void process(const float *interleaved, qsizetype frames, int stride) {
+        m_framePeak.resize(frames);
+        std::fill(m_framePeak.begin(), m_framePeak.end(), 0.0f);
+        for (int c = 0; c < m_channels; ++c) {
+            QVector<float> &x = m_planar[c];
+            x.resize(frames);
+            float *out = x.data();
+            for (qsizetype i = 0; i < frames; ++i) {
+                out[i] = interleaved[i * stride + c];
+            }
+            measureSamples(out, frames);
+            measureTruePeak(c, out, frames);
+            m_filters[c][0].process(out, frames);
+            m_filters[c][1].process(out, frames);
+        }
+        accumulateSilence(frames);
+        accumulateEnergy(frames);
+        m_totalFrames += frames;
+    }
+
+    LoudnessStats finish() const {
+        LoudnessStats stats;
+        stats.valid = m_totalFrames > 0;
+        stats.durationSec = static_cast<double>(m_totalFrames) / m_sampleRate;
+        stats.clippedSamples = m_clipped;
+        stats.truePeakDbtp = amplitudeToDb(std::max(m_samplePeak, m_truePeak));
+        const double windowSec = static_cast<double>(m_silenceWindowFrames) / m_sampleRate;
+        stats.leadingSilenceSec = std::min(stats.durationSec, m_leadingSilentWindows * windowSec);
+        stats.trailingSilenceSec = std::min(stats.durationSec, m_trailingSilentWindows * windowSec);
+
+        double absSum = 0.0;
+        int absCount = 0;
+        for (const double e : m_blockEnergy) {
+            if (energyToLufs(e) > kAbsoluteGateLufs) {
+                absSum += e;
+                ++absCount;
+            }
+        }
+        if (absCount == 0) {
+            stats.integratedLufs = -std::numeric_limits<double>::infinity();
+            return stats;
+        }
+        const double relativeGate = energyToLufs(absSum / absCount) + kRelativeGateLu;
+        double sum = 0.0;
+        int count = 0;
+        for (const double e : m_blockEnergy) {
+            const double lufs = energyToLufs(e);
+            if (lufs > kAbsoluteGateLufs && lufs > relativeGate) {
+                sum += e;
+                ++count;
+            }
+        }
+        stats.integratedLufs = energyToLufs(sum / count);
+        return stats;
+    }
+
+private:
+    void measureSamples(const float *x, qsizetype n) {
+        float peak = 0.0f;
+        qint64 clipped = 0;
+        float *framePeak = m_framePeak.data();
+        for (qsizetype i = 0; i < n; ++i) {
+            const float a = std::fabs(x[i]);
+            peak = std::max(peak, a);
+            clipped += a >= kClipLevel ? 1 : 0;
+            framePeak[i] = std::max(framePeak[i], a);
+        }
+        m_samplePeak = std::max(m_samplePeak, static_cast<double>(peak));
+        m_clipped += clipped;
+    }
+
+    void measureTruePeak(int channel, const float *x, qsizetype n) {
+        QVector<float> &ext = m_extended;
+        QVector<float> &history = m_history[channel];
+        ext.resize(history.size() + n);
+        std::copy(history.cbegin(), history.cend(), ext.begin());
+        std::copy(x, x + n, ext.begin() + history.size());
+        const float *in = ext.constData();
+
+        float peak = 0.0f;
+        for (int p = 0; p < kOversample; ++p) {
+            const float *h = m_phases[p].data();
+            for (qsizetype i = 0; i < n; ++i) {
+                float acc = 0.0f;
+                for (int j = 0; j < kTapsPerPhase; ++j) {
+                    acc += h[j] * in[i + j];
+                }
+                peak = std::max(peak, std::fabs(acc));
+            }
+        }
+        m_truePeak = std::max(m_truePeak, static_cast<double>(peak));
+        std::copy(ext.cend() - history.size(), ext.cend(), history.begin());
+    }
+
+    void accumulateSilence(qsizetype n) {
+        const float *framePeak = m_framePeak.constData();
+        qsizetype i = 0;
+        while (i < n) {
+            const qsizetype take = std::min<qsizetype>(n - i, m_silenceWindowFrames - m_silenceFill);
+            const float peak = *std::max_element(framePeak + i, framePeak + i + take);
+            m_silencePeak = std::max(m_silencePeak, peak);
+            m_silenceFill += take;
+            i += take;
+            if (m_silenceFill < m_silenceWindowFrames) {
+                break;
+            }
+            if (m_silencePeak < kSilenceLevel) {
+                ++m_trailingSilentWindows;
+                if (!m_heardSound) {
+                    ++m_leadingSilentWindows;
+                }
+            } else {
+                m_trailingSilentWindows = 0;
+                m_heardSound = true;
+            }
+            m_silencePeak = 0.0f;
+            m_silenceFill = 0;
+        }
+    }
+
+    void accumulateEnergy(qsizetype n) {
+        qsizetype i = 0;
+        while (i < n) {
+            const qsizetype take = std::min<qsizetype>(n - i, m_subBlockFrames - m_subBlockFill);
+            for (int c = 0; c < m_channels; ++c) {
+                const float *x = m_planar[c].constData() + i;
+                double sum = 0.0;
+                for (qsizetype k = 0; k < take; ++k) {
+                    sum += static_cast<double>(x[k]) * x[k];
+                }
+                m_subBlockSum[c] += sum;
+            }
+            m_subBlockFill += take;
+            i += take;
+            if (m_subBlockFill < m_subBlockFrames) {
+                break;
+            }
+            double energy = 0.0;
+            for (int c = 0; c < m_channels; ++c) {
+                energy += m_subBlockSum[c] / m_subBlockFrames;
+                m_subBlockSum[c] = 0.0;
+            }
+            m_subBlockFill = 0;
+            m_recentSubBlocks[m_subBlockCount % kSubBlocksPerBlock] = energy;
+            ++m_subBlockCount;
+            // 400 ms gating blocks with 75% overlap.
+            if (m_subBlockCount >= kSubBlocksPerBlock) {
+                double block = 0.0;
+                for (const double e : m_recentSubBlocks) {
+                    block += e;
+                }
+                m_blockEnergy.append(block / kSubBlocksPerBlock);
+            }
+        }
+    }
+
+    int m_sampleRate;
+    int m_channels;
+    int m_subBlockFrames;
+    int m_silenceWindowFrames;
+    std::array<std::array<float, kTapsPerPhase>, kOversample> m_phases;
+    std::array<std::array<Biquad, 2>, kMaxChannels> m_filters;
+    std::array<QVector<float>, kMaxChannels> m_planar;
+    std::array<QVector<float>, kMaxChannels> m_history;
+    QVector<float> m_extended;
+    QVector<float> m_framePeak;
+
+    qint64 m_totalFrames = 0;
+    qint64 m_clipped = 0;
+    double m_samplePeak = 0.0;
+    double m_truePeak = 0.0;
+
+    int m_silenceFill = 0;
+    float m_silencePeak = 0.0f;
+    bool m_heardSound = false;
+    qint64 m_leadingSilentWindows = 0;
+    qint64 m_trailingSilentWindows = 0;
+
+    std::array<double, kMaxChannels> m_subBlockSum{};
+    int m_subBlockFill = 0;
+    qint64 m_subBlockCount = 0;
+    std::array<double, kSubBlocksPerBlock> m_recentSubBlocks{};
+    QVector<double> m_blockEnergy;
+};
+}
+
+bool analyzeLoudness(const QString &audioPath, LoudnessStats *stats, QString *error) {
+    AudioDecodeOptions options;
+    options.channelCount = kMaxChannels;
+    std::unique_ptr<LoudnessMeter> meter;
+    const bool ok = decodeAudioStream(
+        audioPath, options,
+        [&](const float *samples, qsizetype frames, const AudioStreamInfo &info) {
+            if (!meter) {
+                if (info.sampleRate <= 0) {
+                    return false;
+                }
+                // Mono sources are duplicated by the decoder; measure them once.
+                const int channels = info.sourceChannelCount == 1 ? 1 : info.channelCount;
+                meter = std::make_unique<LoudnessMeter>(info.sampleRate, channels);
+            }
+            meter->process(samples, frames, info.channelCount);
+            return true;
+        },
+        error);
+    if (!ok) {
+        return false;
+    }
+    if (!meter) {
+        if (error) {
+            *error = QStringLiteral("No audio decoded");
+        }
+        return false;
+    }
+    *stats = meter->finish();
+    return true;
+}
+
+QString loudnessSummary(const LoudnessStats &stats) {
+    if (!stats.valid) {
+        return QString();
+    }
+    const QString loudness = std::isfinite(stats.integratedLufs)
+                                 ? QStringLiteral("%1 LUFS").arg(stats.integratedLufs, 0, 'f', 1)
+                                 : QStringLiteral("silent");
+    QString text = QStringLiteral("%1 · %2 dBTP").arg(loudness).arg(stats.truePeakDbtp, 0, 'f', 1);
+    if (stats.clippedSamples > 0) {
+        text += QStringLiteral(" · %1 clipped").arg(stats.clippedSamples);
+    }
+    if (stats.leadingSilenceSec >= 0.05 || stats.trailingSilenceSec >= 0.05) {
+        text += QStringLiteral(" · silence %1 s / %2 s")
+                    .arg(stats.leadingSilenceSec, 0, 'f', 1)
+                    .arg(stats.trailingSilenceSec, 0, 'f', 1);
+    }
+    return text;
+}
+
+QStringList loudnessIssues(const LoudnessStats &stats) {
+    QStringList issues;
+    if (!stats.valid) {
+        return issues;
+    }
+    if (stats.clippedSamples > 0) {
+        issues << QStringLiteral("%1 samples at full scale").arg(stats.clippedSamples);
+    }
+    if (stats.truePeakDbtp > 0.0) {
+        issues << QStringLiteral("Inter-sample peaks above 0 dBTP");
+    }
+    if (!std::isfinite(stats.integratedLufs) || stats.integratedLufs < kQuietLufs) {
+        issues << QStringLiteral("Very quiet or silent");
+    }
+    if (stats.leadingSilenceSec >= kLongSilenceSec) {
+        issues << QStringLiteral("%1 s of leading silence").arg(stats.leadingSilenceSec, 0, 'f', 1);
+    }
+    if (stats.trailingSilenceSec >= kLongSilenceSec) {
+        issues << QStringLiteral("%1 s of trailing silence").arg(stats.trailingSilenceSec, 0, 'f', 1);
+    }
+    return issues;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+struct LoudnessStats {
+    bool valid = false;
+    double integratedLufs = 0.0;
+    double truePeakDbtp = 0.0;
+    qint64 clippedSamples = 0;
+    double leadingSilenceSec = 0.0;
+    double trailingSilenceSec = 0.0;
+    double durationSec = 0.0;
+};
+
+Q_DECLARE_METATYPE(LoudnessStats)
+
+// Streams the whole file at its native rate: BS.1770 gated integrated
+// loudness, 4x oversampled true peak, full-scale sample count and the
+// silent spans (below -60 dBFS) at either end.
+bool analyzeLoudness(const QString &audioPath, LoudnessStats *stats, QString *error = nullptr);
+
+QString loudnessSummary(const LoudnessStats &stats);
+QStringList loudnessIssues(const LoudnessStats &stats);
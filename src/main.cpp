@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "tracing.h"
 
 #include <QApplication>
 #include <QColor>
@@ -6,10 +7,12 @@
 #include <QStyleFactory>
 
 int main(int argc, char *argv[]) {
+    const qint64 processStartNs = Tracer::now();
     QApplication app(argc, argv);
     app.setOrganizationName("NEYROSLAV");
     app.setApplicationName("AceStep15DatasetManager");
     app.setStyle(QStyleFactory::create("Fusion"));
+    installKeystrokeLatencyMonitor(&app);
 
     QPalette dark;
     dark.setColor(QPalette::Window, QColor(31, 37, 48));
@@ -42,6 +45,7 @@ int main(int argc, char *argv[]) {
         " }");
 
     MainWindow w;
+    w.trackColdStart(processStartNs);
     w.show();
     return app.exec();
 }
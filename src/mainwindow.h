@@ -1,40 +1,55 @@
 #pragma once
 
+#include "analysisjob.h"
 #include "audioitemwidget.h"
+#include "datasetio.h"
+#include "datasetmerge.h"
+#include "rowindex.h"
+#include "searchindex.h"
+#include "shardexport.h"
+#include "trackedits.h"
+#include "trackfilter.h"
+#include "trackvalidator.h"
+#include "workspace.h"
 
-#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QKeySequence>
 #include <QMainWindow>
+#include <QPointer>
+#include <QSet>
 #include <QUrl>
 
 class QCheckBox;
 class QCloseEvent;
+class QDialog;
 class QComboBox;
 class QGroupBox;
-class QKeySequenceEdit;
 class QLabel;
 class QLineEdit;
+class QPaintEvent;
+class QPushButton;
+class QProgressBar;
 class QResizeEvent;
 class QScrollArea;
 class QSlider;
 class QSpinBox;
 class QShortcut;
+class QTimer;
+class QToolButton;
+class QTreeWidget;
+class QUndoStack;
 class QWidget;
 class QVBoxLayout;
 
-struct DatasetMetadata {
-    QString name = "Dataset";
-    QString customTag;
-    QString tagPosition = "prepend";
-    QDateTime createdAt = QDateTime::currentDateTimeUtc();
-    bool allInstrumental = false;
-    int genreRatio = 0;
-};
-
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
     explicit MainWindow(QWidget *parent = nullptr);
+    // Reports the time from processStartNs (a Tracer::now() value) to the
+    // first frame in the trace and the Diagnostics panel.
+    void trackColdStart(qint64 processStartNs);
 
 private slots:
     void openDatasetJsonFile();
@@ -43,7 +58,16 @@ private slots:
     void saveDatasetAs();
     void refreshDataset();
     void mergeParagraphs();
+    void showFindReplaceDialog();
     void makeBackup();
+    void exportJsonl();
+    void showShardExportDialog();
+    void showMergeDialog();
+    void addWorkspaceFolder();
+    void addWorkspaceFile();
+    void removeWorkspaceDataset();
+    void refreshWorkspaceSummaries();
+    void exportTrace();
     void expandAll();
     void collapseAll();
     void updateStats();
@@ -54,35 +78,115 @@ private slots:
     void onDatasetScrollChanged(int value);
     void showCaptionTutorial();
     void showLyricsTutorial();
-    void onAlwaysOnTopChanged();
+    void setAlwaysOnTop(bool onTop);
     void toggleFocusMode();
     void togglePlaybackOnTargetTrack();
     void seekPlaybackBackward();
     void seekPlaybackForward();
+    void runSearch();
+    void showNextSearchResult();
+    void showPreviousSearchResult();
+    void applyTrackView();
+    void undoDatasetEdit();
+    void redoDatasetEdit();
+    void startBpmAnalysis();
+    void startKeyAnalysis();
+    void startDuplicateScan();
+    void startLoudnessAnalysis();
+    void startVocalAnalysis();
+    void startTranscode();
+    void startValidation();
+    void acceptSuggestions();
+    void selectShownTracks();
+    void clearTrackSelection();
+    void deleteSelectedTracks();
+    void moveSelectedTracksTo();
+    void applyFieldToSelected();
 
 private:
     void closeEvent(QCloseEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
     void setupUi();
+    void buildHelpSection(QGroupBox *group);
+    void buildSettingsSection(QGroupBox *group);
+    void buildAboutSection(QGroupBox *group);
+    void buildDiagnosticsSection(QGroupBox *group);
+    void buildWorkspaceSection(QGroupBox *group);
+    void updateColdStartLabel();
     void clearTracks();
-    void rebuildTrackList(const QList<TrackData> &tracks);
+    void rebuildTrackList(const QList<TrackData> &tracks, int anchorIndex = 0);
+    AudioItemWidget *createTrackCard(int index);
+    void materializeTracks(qint64 budgetNs);
+    void finishTrackMaterialization();
+    bool isMaterializingTracks() const;
+    AudioItemWidget *cardAtViewportTop() const;
+    void refreshVisibleIndexLabels();
     QList<TrackData> collectTracks() const;
+    DatasetMetadata currentMetadata() const;
+    bool writeDatasetFile(const QString &path, const DatasetMetadata &meta, QString *error = nullptr) const;
+    void openDatasetFile(const QString &jsonPath);
+    void openWorkspaceDataset(const QString &path);
+    void addWorkspaceDatasets(const QStringList &paths);
+    void populateWorkspaceTree();
+    void updateWorkspaceRow(const DatasetSummary &summary);
+    bool isOpenDataset(const QString &path) const;
     void loadFromFolder(const QString &folderPath);
-    QList<TrackData> buildFromAudioFiles(const QString &folderPath) const;
-    bool loadFromJson(const QString &jsonPath);
+    static QList<TrackData> buildFromAudioFiles(const QString &folderPath);
+    bool loadFromJson(const QString &jsonPath, QString *error = nullptr);
+    static LoadedDataset readDatasetFolder(const QString &folderPath);
+    void applyDataset(const LoadedDataset &dataset, int anchorIndex = 0);
+    void saveSession() const;
+    void restoreSession();
     QString defaultJsonPath() const;
     QString currentTimestampFileSafe() const;
-    QString generateId(const QString &source) const;
-    static QString sanitizeTagPosition(const QString &value);
     void showTutorialDialog(const QString &title, const QString &markdown, const QUrl &baseUrl = QUrl()) const;
     void showPathToast(const QString &prefix, const QString &filePath);
     void positionToast();
     int unsavedCardsCount() const;
     bool hasUnsavedMetaChanges() const;
     bool hasUnsavedChanges() const;
+    bool requireOpenDataset(const QString &title);
+    // Offers to save unsaved changes; false when the user cancels.
+    bool confirmDiscardChanges(const QString &question);
     void captureMetaSnapshot();
     void updateMainWindowTitle();
     AudioItemWidget *playbackTargetTrack() const;
+    void schedulePlaybackPrefetch(AudioItemWidget *anchor);
+    void prefetchPlaybackAfterAnchor();
+    void onTrackChanged(AudioItemWidget *item);
+    void pushCardEdits(const QString &text, const QList<CardFieldEdit> &edits,
+                       bool alreadyApplied = false);
+    void flushPendingCardEdits();
+    void applyCardEdits(const QList<CardFieldEdit> &edits, bool undo);
+    void rebuildSearchIndex(const QList<TrackData> &tracks);
+    void flushSearchIndexUpdates();
+    void focusSearchResult(int pos);
+    void clearSearchResults();
+    void updateSearchStatus();
+    void refreshTrackViewRows();
+    bool isTrackViewActive() const;
+    void startAnalysis(const QString &name, const QString &field, AnalysisFn analyze);
+    void onAnalysisResult(const AnalysisResult &result);
+    void onAnalysisFinished(bool canceled);
+    void updateAnalysisStatus();
+    void findDuplicates(const QList<QPointer<AudioItemWidget>> &analysedCards);
+    void showDuplicatesDialog(const QList<QPointer<AudioItemWidget>> &cards,
+                              const QList<QVector<int>> &clusters);
+    void removeTracks(const QList<AudioItemWidget *> &items);
+    void moveTracks(const QList<AudioItemWidget *> &items, int targetRow);
+    void applyTrackOrder(const TrackMoveCommand::CardOrder &cards);
+    // order[i] is the current row of the card that goes to row i; false
+    // when that is the current order.
+    bool reorderTrackRows(const QVector<int> &order);
+    void applyFieldToCards(const QList<AudioItemWidget *> &cards, const QString &field, const QString &value,
+                           const QString &text);
+    void onCardSelectionClicked(AudioItemWidget *card, bool selected, bool extend);
+    void setCardsSelected(const QList<AudioItemWidget *> &cards, bool selected);
+    QList<AudioItemWidget *> selectedTracks() const;
+    void updateSelectionBar();
+    void scrollToCard(AudioItemWidget *w);
+    void updateDiagnostics();
 
     DatasetMetadata m_meta;
     QString m_currentFolder;
@@ -93,7 +197,30 @@ private:
     QWidget *m_datasetContainer = nullptr;
     QScrollArea *m_datasetScroll = nullptr;
     QVBoxLayout *m_trackLayout = nullptr;
+    // Built cards in dataset order. While a load is still materializing
+    // they cover m_pendingTracks[m_builtBegin, m_builtEnd).
     QList<AudioItemWidget *> m_trackWidgets;
+    // Lookups that would otherwise scan m_trackWidgets. A card's slot is its
+    // position in the loaded dataset; m_rowIndex turns it into the row shown
+    // on the card once earlier cards have been deleted.
+    QMultiHash<QString, AudioItemWidget *> m_cardsById;
+    QHash<AudioItemWidget *, int> m_cardSlots;
+    RowIndex m_rowIndex;
+    bool m_indexLabelsStale = false;
+    QSet<AudioItemWidget *> m_selectedCards;
+    QPointer<AudioItemWidget> m_selectionAnchor;
+    QWidget *m_selectionBar = nullptr;
+    QLabel *m_selectionLabel = nullptr;
+    QList<TrackData> m_pendingTracks;
+    int m_builtBegin = 0;
+    int m_builtEnd = 0;
+    QTimer *m_materializeTimer = nullptr;
+    int m_datasetGeneration = 0;
+    QString m_restoreFocusTrackId;
+    QString m_restoreFocusField;
+    // Set while restoreSession parses the last dataset in the background;
+    // m_currentFolder already names it but no card exists yet.
+    bool m_restorePending = false;
 
     QLineEdit *m_nameEdit = nullptr;
     QLineEdit *m_customTagEdit = nullptr;
@@ -102,23 +229,32 @@ private:
     QSlider *m_genreRatioSlider = nullptr;
     QLabel *m_genreRatioLabel = nullptr;
 
-    QSlider *m_fontSlider = nullptr;
-    QLabel *m_fontSizeValueLabel = nullptr;
-    QCheckBox *m_onTopCheck = nullptr;
-    QCheckBox *m_captionLyricsOnlyCheck = nullptr;
-    QSpinBox *m_seekStepSecondsSpin = nullptr;
-    QKeySequenceEdit *m_focusShortcutEdit = nullptr;
-    QShortcut *m_focusShortcut = nullptr;
-    QKeySequenceEdit *m_saveShortcutEdit = nullptr;
-    QShortcut *m_saveShortcut = nullptr;
-    QKeySequenceEdit *m_backupShortcutEdit = nullptr;
-    QShortcut *m_backupShortcut = nullptr;
-    QKeySequenceEdit *m_playPauseShortcutEdit = nullptr;
-    QShortcut *m_playPauseShortcut = nullptr;
-    QKeySequenceEdit *m_seekBackwardShortcutEdit = nullptr;
-    QKeySequenceEdit *m_seekForwardShortcutEdit = nullptr;
-    QShortcut *m_seekBackwardShortcut = nullptr;
-    QShortcut *m_seekForwardShortcut = nullptr;
+    // Settings values live here rather than in the panel widgets, which are
+    // only created once the Settings section is opened.
+    int m_uiFontSize = 10;
+    bool m_alwaysOnTop = false;
+    bool m_captionLyricsOnly = false;
+    bool m_pcmPlayback = false;
+    bool m_showSpectrogram = false;
+    int m_seekStepSeconds = 10;
+    int m_transcodeSampleRate = 48000;
+    int m_transcodeChannels = 2;
+    bool m_restoreSession = true;
+    bool m_shardExportRunning = false;
+    bool m_mergeRunning = false;
+    // Read from disk when the Workspace section is first opened.
+    WorkspaceIndex m_workspace;
+    QTreeWidget *m_workspaceTree = nullptr;
+    QLabel *m_workspaceStatusLabel = nullptr;
+    bool m_workspaceRefreshRunning = false;
+    bool m_workspaceRefreshQueued = false;
+    struct ShortcutSetting {
+        QShortcut *shortcut = nullptr;
+        QString label;
+        QString settingsKey;
+        QKeySequence defaultSequence;
+    };
+    QList<ShortcutSetting> m_shortcutSettings;
     QGroupBox *m_globalGroup = nullptr;
     QWidget *m_rightPanel = nullptr;
     bool m_focusMode = false;
@@ -128,8 +264,71 @@ private:
     QLabel *m_lyricsDoneLabel = nullptr;
     QLabel *m_lyricsLeftLabel = nullptr;
     QLabel *m_unsavedCardsLabel = nullptr;
+    QLabel *m_coldStartLabel = nullptr;
+    QLabel *m_traceInfoLabel = nullptr;
+    QLabel *m_latencyLabel = nullptr;
+    QTimer *m_diagnosticsTimer = nullptr;
+    qint64 m_processStartNs = -1;
+    qint64 m_coldStartNs = -1;
     QWidget *m_saveToast = nullptr;
     AudioItemWidget *m_lastPlaybackActiveTrack = nullptr;
+    QPointer<AudioItemWidget> m_playingTrack;
+    QTimer *m_playbackPrefetchTimer = nullptr;
+    QPointer<AudioItemWidget> m_playbackPrefetchAnchor;
+    QList<QPointer<AudioItemWidget>> m_playbackPrefetchCards;
+
+    QLineEdit *m_searchEdit = nullptr;
+    QLabel *m_searchStatusLabel = nullptr;
+    QTimer *m_searchTimer = nullptr;
+    QTimer *m_searchUpdateTimer = nullptr;
+    SearchIndex m_searchIndex;
+    // Each card's document key: its position in the list the index was
+    // built from. Unlike slots it survives moves, and unlike ids it is unique.
+    QHash<AudioItemWidget *, int> m_searchKeys;
+    bool m_searchIndexReady = false;
+    int m_searchGeneration = 0;
+    QSet<AudioItemWidget *> m_searchDirtyCards;
+    QStringList m_searchTerms;
+    QList<AudioItemWidget *> m_searchResults;
+    QList<AudioItemWidget *> m_searchHighlightedCards;
+    int m_searchCurrent = -1;
+
+    QComboBox *m_filterCombo = nullptr;
+    QLineEdit *m_filterValueEdit = nullptr;
+    QComboBox *m_sortCombo = nullptr;
+    QToolButton *m_sortOrderBtn = nullptr;
+    QLabel *m_filterStatusLabel = nullptr;
+    QTimer *m_filterTimer = nullptr;
+    TrackListView m_trackView;
+    QSet<AudioItemWidget *> m_trackViewStaleCards;
+
+    QUndoStack *m_undoStack = nullptr;
+    // Every move gives the order it produces a new serial, and undo or redo
+    // restores the serial of the order it returns to; 0 is the order as
+    // loaded. The order is unsaved while it differs from the saved serial.
+    int m_trackOrderSerial = 0;
+    int m_savedTrackOrderSerial = 0;
+    int m_lastTrackOrderSerial = 0;
+    bool m_bulkEditing = false;
+
+    AnalysisJob *m_analysisJob = nullptr;
+    QProgressBar *m_analysisProgress = nullptr;
+    QLabel *m_analysisStatusLabel = nullptr;
+    QPushButton *m_analysisCancelBtn = nullptr;
+    QSpinBox *m_suggestionConfidenceSpin = nullptr;
+    // The running job's cards, indexed by AnalysisTarget::row.
+    QList<QPointer<AudioItemWidget>> m_analysisCards;
+    int m_analysisDone = 0;
+    int m_analysisTotal = 0;
+    int m_analysisSuggested = 0;
+    int m_analysisFailed = 0;
+    int m_analysisFlagged = 0;
+    QElapsedTimer m_analysisClock;
+    QList<CardFieldEdit> m_transcodeEdits;
+    QPointer<QDialog> m_validationDialog;
+    bool m_validationRunning = false;
+    qint64 m_transcodeSourceBytes = 0;
+    double m_transcodeAudioSeconds = 0.0;
 
     QString m_savedName;
     QString m_savedCustomTag;
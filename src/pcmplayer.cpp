@@ -0,0 +1,369 @@
+#include "pcmplayer.h"
+
+#include "audiodecode.h"
+
+#include <QAudioDevice>
+#include <QAudioFormat>
+#include <QAudioSink>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr int kChannels = 2;
+constexpr int kWindowSeconds = 60;
+constexpr int kKeepBehindSeconds = 20;
+constexpr int kSinkBufferMs = 40;
+constexpr int kPositionIntervalMs = 50;
+}
+
+// Decoded frames [startFrame, endFrame) live in a fixed ring; frame f sits
+// at slot f % capacity. The decoder only ever appends and may drop the
+// oldest frames once they are far enough behind the playhead. A restart
+// decodes from the top again but only stores frames from just behind the
+// playhead on.
+class PcmRing {
+public:
+    QMutex mutex;
+    QWaitCondition changed;
+    int sampleRate = 0;
+    qint64 capacity = 0;
+    QVector<qint16> samples;
+    qint64 startFrame = 0;
+    qint64 endFrame = 0;
+    qint64 readFrame = 0;
+    qint64 pendingPositionMs = 0;
+    bool finished = false;
+    bool restart = false;
+    bool abort = false;
+
+    qint64 keepBehindFrames() const { return static_cast<qint64>(sampleRate) * kKeepBehindSeconds; }
+
+    void reset() {
+        startFrame = std::max<qint64>(0, readFrame - keepBehindFrames());
+        endFrame = startFrame;
+        finished = false;
+        restart = false;
+    }
+
+    void copyOut(qint64 frame, qint16 *out, qint64 frames) const {
+        while (frames > 0) {
+            const qint64 slot = frame % capacity;
+            const qint64 run = std::min(frames, capacity - slot);
+            std::memcpy(out, samples.constData() + slot * kChannels, run * kChannels * sizeof(qint16));
+            out += run * kChannels;
+            frame += run;
+            frames -= run;
+        }
+    }
+
+    void copyIn(const qint16 *in, qint64 frames) {
+        while (frames > 0) {
+            const qint64 slot = endFrame % capacity;
+            const qint64 run = std::min(frames, capacity - slot);
+            std::memcpy(samples.data() + slot * kChannels, in, run * kChannels * sizeof(qint16));
+            in += run * kChannels;
+            endFrame += run;
+            frames -= run;
+        }
+    }
+};
+
+class PcmRingDevice : public QIODevice {
+public:
+    explicit PcmRingDevice(std::shared_ptr<PcmRing> ring, QObject *parent)
+        : QIODevice(parent), m_ring(std::move(ring)) {}
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override {
+        const qint64 frameBytes = kChannels * static_cast<qint64>(sizeof(qint16));
+        const qint64 wanted = maxSize / frameBytes;
+        QMutexLocker lock(&m_ring->mutex);
+        const qint64 available =
+            m_ring->readFrame >= m_ring->startFrame ? std::max<qint64>(0, m_ring->endFrame - m_ring->readFrame) : 0;
+        const qint64 frames = std::min(wanted, available);
+        if (frames == 0) {
+            if (m_ring->finished && m_ring->readFrame >= m_ring->endFrame) {
+                return 0;
+            }
+            // Underrun right after a seek ahead: keep the sink fed with silence.
+            std::memset(data, 0, wanted * frameBytes);
+            return wanted * frameBytes;
+        }
+        m_ring->copyOut(m_ring->readFrame, reinterpret_cast<qint16 *>(data), frames);
+        m_ring->readFrame += frames;
+        m_ring->changed.wakeAll();
+        return frames * frameBytes;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    std::shared_ptr<PcmRing> m_ring;
+};
+
+PcmPlayer::PcmPlayer(const QString &path, QObject *parent)
+    : QObject(parent), m_path(path), m_ring(std::make_shared<PcmRing>()) {
+    m_device = new PcmRingDevice(m_ring, this);
+    m_device->open(QIODevice::ReadOnly);
+    m_positionTimer = new QTimer(this);
+    m_positionTimer->setInterval(kPositionIntervalMs);
+    connect(m_positionTimer, &QTimer::timeout, this, [this]() { emit positionChanged(position()); });
+    m_decoderThread = QThread::create([this]() { decodeLoop(); });
+    m_decoderThread->start(QThread::LowPriority);
+}
+
+PcmPlayer::~PcmPlayer() {
+    {
+        QMutexLocker lock(&m_ring->mutex);
+        m_ring->abort = true;
+        m_ring->changed.wakeAll();
+    }
+    if (m_sink) {
+        m_sink->stop();
+    }
+    m_decoderThread->wait();
+    delete m_decoderThread;
+}
+
+void PcmPlayer::decodeLoop() {
+    AudioDecodeOptions options;
+    options.channelCount = kChannels;
+    QVector<qint16> converted;
+    while (true) {
+        {
+            QMutexLocker lock(&m_ring->mutex);
+            if (m_ring->abort) {
+                return;
+            }
+            m_ring->reset();
+        }
+        qint64 decodedFrames = 0;
+        decodeAudioStream(m_path, options, [&](const float *samples, qsizetype frames, const AudioStreamInfo &info) {
+            QMutexLocker lock(&m_ring->mutex);
+            if (m_ring->capacity == 0) {
+                m_ring->sampleRate = info.sampleRate;
+                m_ring->capacity = static_cast<qint64>(info.sampleRate) * kWindowSeconds;
+                m_ring->samples.resize(m_ring->capacity * kChannels);
+                m_ring->readFrame = m_ring->pendingPositionMs * info.sampleRate / 1000;
+                m_ring->reset();
+                QMetaObject::invokeMethod(this, [this]() { onFormatReady(); }, Qt::QueuedConnection);
+            }
+            if (m_ring->abort || m_ring->restart) {
+                return false;
+            }
+            // Frames before the window start are decoded again but not stored.
+            const qint64 skipped = std::clamp<qint64>(m_ring->endFrame - decodedFrames, 0, frames);
+            decodedFrames += frames;
+            if (skipped == frames) {
+                return true;
+            }
+            lock.unlock();
+            converted.resize((frames - skipped) * kChannels);
+            const float *source = samples + skipped * kChannels;
+            for (qsizetype i = 0; i < converted.size(); ++i) {
+                converted[i] = static_cast<qint16>(std::lround(std::clamp(source[i], -1.0f, 1.0f) * 32767.0f));
+            }
+            lock.relock();
+            const qint16 *in = converted.constData();
+            qint64 remaining = frames - skipped;
+            while (remaining > 0) {
+                if (m_ring->abort || m_ring->restart) {
+                    return false;
+                }
+                qint64 free = m_ring->capacity - (m_ring->endFrame - m_ring->startFrame);
+                if (free == 0) {
+                    const qint64 droppable =
+                        std::min(m_ring->readFrame, m_ring->endFrame) - m_ring->keepBehindFrames() - m_ring->startFrame;
+                    if (droppable <= 0) {
+                        m_ring->changed.wait(&m_ring->mutex);
+                        continue;
+                    }
+                    m_ring->startFrame += std::min(droppable, remaining);
+                    free = m_ring->capacity - (m_ring->endFrame - m_ring->startFrame);
+                }
+                const qint64 run = std::min(free, remaining);
+                m_ring->copyIn(in, run);
+                in += run * kChannels;
+                remaining -= run;
+            }
+            return true;
+        });
+
+        QMutexLocker lock(&m_ring->mutex);
+        if (m_ring->capacity == 0 && !m_ring->abort) {
+            QMetaObject::invokeMethod(this, [this]() { fail(); }, Qt::QueuedConnection);
+            return;
+        }
+        if (!m_ring->restart) {
+            m_ring->finished = true;
+            while (!m_ring->abort && !m_ring->restart) {
+                m_ring->changed.wait(&m_ring->mutex);
+            }
+        }
+    }
+}
+
+void PcmPlayer::onFormatReady() {
+    if (m_state == QMediaPlayer::PlayingState && ensureSink()) {
+        m_sink->start(m_device);
+    }
+}
+
+void PcmPlayer::fail() {
+    if (m_failed) {
+        return;
+    }
+    m_failed = true;
+    emit playbackFailed();
+}
+
+bool PcmPlayer::ensureSink() {
+    if (m_sink) {
+        return true;
+    }
+    if (m_failed) {
+        return false;
+    }
+    QAudioFormat format;
+    format.setSampleRate(m_ring->sampleRate);
+    format.setChannelCount(kChannels);
+    format.setSampleFormat(QAudioFormat::Int16);
+    const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    if (device.isNull() || !device.isFormatSupported(format)) {
+        fail();
+        return false;
+    }
+    m_sink = new QAudioSink(device, format, this);
+    // A short device buffer keeps a seek audible within a few tens of ms.
+    m_sink->setBufferSize(format.bytesForDuration(kSinkBufferMs * 1000));
+    m_sink->setVolume(m_volume);
+    connect(m_sink, &QAudioSink::stateChanged, this, [this](QAudio::State state) {
+        if (state == QAudio::StoppedState && m_sink->error() != QAudio::NoError &&
+            m_sink->error() != QAudio::UnderrunError) {
+            fail();
+            return;
+        }
+        if (state != QAudio::IdleState || m_state != QMediaPlayer::PlayingState) {
+            return;
+        }
+        QMutexLocker lock(&m_ring->mutex);
+        if (m_ring->finished && m_ring->readFrame >= m_ring->endFrame) {
+            lock.unlock();
+            m_sink->stop();
+            setState(QMediaPlayer::StoppedState);
+            emit positionChanged(position());
+        }
+    });
+}
+
+QMediaPlayer::PlaybackState PcmPlayer::playbackState() const {
+    return m_state;
+}
+
+qint64 PcmPlayer::position() const {
+    QMutexLocker lock(&m_ring->mutex);
+    if (m_ring->sampleRate <= 0) {
+        return m_ring->pendingPositionMs;
+    }
+    qint64 frame = m_ring->readFrame;
+    if (m_sink && m_state == QMediaPlayer::PlayingState) {
+        const qint64 queued = (m_sink->bufferSize() - m_sink->bytesFree()) / (kChannels * sizeof(qint16));
+        frame = std::max<qint64>(0, frame - queued);
+    }
+    return frame * 1000 / m_ring->sampleRate;
+}
+
+void PcmPlayer::setPosition(qint64 positionMs) {
+    {
+        QMutexLocker lock(&m_ring->mutex);
+        if (m_ring->sampleRate <= 0) {
+            m_ring->pendingPositionMs = std::max<qint64>(0, positionMs);
+            return;
+        }
+        const qint64 frame = std::max<qint64>(0, positionMs) * m_ring->sampleRate / 1000;
+        m_ring->readFrame = frame;
+        if (frame < m_ring->startFrame) {
+            m_ring->restart = true;
+        }
+        m_ring->changed.wakeAll();
+    }
+    if (m_sink && m_state == QMediaPlayer::PlayingState) {
+        // Drop what the device still holds from the old position.
+        m_sink->stop();
+        m_sink->start(m_device);
+    }
+    emit positionChanged(position());
+}
+
+void PcmPlayer::setVolume(float volume) {
+    m_volume = volume;
+    if (m_sink) {
+        m_sink->setVolume(volume);
+    }
+}
+
+void PcmPlayer::play() {
+    if (m_state == QMediaPlayer::PlayingState) {
+        return;
+    }
+    bool atEnd = false;
+    bool formatKnown = false;
+    {
+        QMutexLocker lock(&m_ring->mutex);
+        atEnd = m_ring->finished && m_ring->readFrame >= m_ring->endFrame;
+        formatKnown = m_ring->sampleRate > 0;
+    }
+    if (atEnd) {
+        setPosition(0);
+    }
+    setState(QMediaPlayer::PlayingState);
+    if (!formatKnown || !ensureSink()) {
+        return;
+    }
+    m_sink->start(m_device);
+}
+
+void PcmPlayer::pause() {
+    if (m_state != QMediaPlayer::PlayingState) {
+        return;
+    }
+    // Rewind past whatever the device had queued so resume is seamless.
+    const qint64 pos = position();
+    if (m_sink) {
+        m_sink->stop();
+    }
+    setState(QMediaPlayer::PausedState);
+    setPosition(pos);
+}
+
+void PcmPlayer::stop() {
+    if (m_sink) {
+        m_sink->stop();
+    }
+    setState(QMediaPlayer::StoppedState);
+    setPosition(0);
+}
+
+void PcmPlayer::setState(QMediaPlayer::PlaybackState state) {
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    if (state == QMediaPlayer::PlayingState) {
+        m_positionTimer->start();
+    } else {
+        m_positionTimer->stop();
+    }
+    emit playbackStateChanged(state);
+}
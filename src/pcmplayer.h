@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QMediaPlayer>
+#include <QObject>
+#include <QString>
+
+#include <memory>
+
+class QAudioSink;
+class QThread;
+class QTimer;
+class PcmRing;
+class PcmRingDevice;
+
+// Plays a file from a window of decoded PCM kept around the playhead.
+// Seeks inside the window only move a read index; the decoder thread keeps
+// filling ahead and restarts from the top for seeks behind the window,
+// storing only frames from just behind the new position.
+class PcmPlayer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PcmPlayer(const QString &path, QObject *parent = nullptr);
+    ~PcmPlayer() override;
+
+    QMediaPlayer::PlaybackState playbackState() const;
+    qint64 position() const;
+    void setPosition(qint64 positionMs);
+    void setVolume(float volume);
+
+public slots:
+    void play();
+    void pause();
+    void stop();
+
+signals:
+    void positionChanged(qint64 positionMs);
+    void playbackStateChanged(QMediaPlayer::PlaybackState state);
+    // The file could not be decoded or the audio device refused the stream;
+    // emitted at most once.
+    void playbackFailed();
+
+private:
+    void decodeLoop();
+    void onFormatReady();
+    void fail();
+    bool ensureSink();
+    void setState(QMediaPlayer::PlaybackState state);
+
+    QString m_path;
+    std::shared_ptr<PcmRing> m_ring;
+    PcmRingDevice *m_device = nullptr;
+    QAudioSink *m_sink = nullptr;
+    QThread *m_decoderThread = nullptr;
+    QTimer *m_positionTimer = nullptr;
+    QMediaPlayer::PlaybackState m_state = QMediaPlayer::StoppedState;
+    float m_volume = 1.0f;
+    bool m_failed = false;
+};
@@ -0,0 +1,41 @@
+#include "rowindex.h"
+
+void RowIndex::reset(int slotCount) {
+    m_tree.fill(0, slotCount + 1);
+    m_live.fill(true, slotCount);
+    m_liveCount = slotCount;
+    for (int i = 1; i <= slotCount; ++i) {
+        m_tree[i] += 1;
+        const int parent = i + (i & -i);
+        if (parent <= slotCount) {
+            m_tree[parent] += m_tree[i];
+        }
+    }
+}
+
+void RowIndex::remove(int slot) {
+    if (!isLive(slot)) {
+        return;
+    }
+    m_live[slot] = false;
+    --m_liveCount;
+    for (int i = slot + 1; i < m_tree.size(); i += i & -i) {
+        m_tree[i] -= 1;
+    }
+}
+
+bool RowIndex::isLive(int slot) const {
+    return slot >= 0 && slot < m_live.size() && m_live[slot];
+}
+
+int RowIndex::rowOf(int slot) const {
+    int row = 0;
+    for (int i = slot + 1; i > 0; i -= i & -i) {
+        row += m_tree[i];
+    }
+    return row;
+}
+
+int RowIndex::liveCount() const {
+    return m_liveCount;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QVector>
+
+// Row numbers for a list that only loses entries between reloads. Each entry
+// keeps the slot it was loaded into; its row is the number of live slots up
+// to and including that slot. A Fenwick tree keeps both removal and lookup
+// at O(log n), so deleting a card does not renumber every card after it.
+class RowIndex {
+public:
+    void reset(int slotCount);
+    void remove(int slot);
+    bool isLive(int slot) const;
+    // 1-based row of a live slot.
+    int rowOf(int slot) const;
+    int liveCount() const;
+
+private:
+    QVector<int> m_tree;
+    QVector<bool> m_live;
+    int m_liveCount = 0;
+};
@@ -0,0 +1,176 @@
+#include "searchindex.h"
+
+#include <QFileInfo>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace {
+void insertSorted(QVector<int> &list, int doc) {
+    auto it = std::lower_bound(list.begin(), list.end(), doc);
+    if (it == list.end() || *it != doc) {
+        list.insert(it, doc);
+    }
+}
+
+void eraseSorted(QVector<int> &list, int doc) {
+    auto it = std::lower_bound(list.begin(), list.end(), doc);
+    if (it != list.end() && *it == doc) {
+        list.erase(it);
+    }
+}
+}
+
+SearchIndex SearchIndex::build(const QList<TrackData> &tracks) {
+    SearchIndex index;
+    index.m_docKeys.reserve(tracks.size());
+    index.m_docTokens.reserve(tracks.size());
+    for (int i = 0; i < tracks.size(); ++i) {
+        index.setDocument(i, searchableTexts(tracks[i]));
+    }
+    return index;
+}
+
+QStringList SearchIndex::searchableTexts(const TrackData &track) {
+    const QString name =
+        track.filename.isEmpty() ? QFileInfo(track.audioPath).fileName() : track.filename;
+    return {track.caption, track.lyrics, track.genre, name};
+}
+
+QStringList SearchIndex::tokenize(const QString &text) {
+    QStringList tokens;
+    QString current;
+    for (const QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            current += ch.toLower();
+        } else if (!current.isEmpty()) {
+            tokens.append(current);
+            current.clear();
+        }
+    }
+    if (!current.isEmpty()) {
+        tokens.append(current);
+    }
+    return tokens;
+}
+
+void SearchIndex::clear() {
+    m_docByKey.clear();
+    m_docKeys.clear();
+    m_docTokens.clear();
+    m_freeDocs.clear();
+    m_postings.clear();
+}
+
+void SearchIndex::setDocument(int key, const QStringList &texts) {
+    QStringList tokens;
+    for (const QString &text : texts) {
+        tokens += tokenize(text);
+    }
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    int doc = m_docByKey.value(key, -1);
+    if (doc < 0) {
+        if (!m_freeDocs.isEmpty()) {
+            doc = m_freeDocs.takeLast();
+            m_docKeys[doc] = key;
+        } else {
+            doc = m_docKeys.size();
+            m_docKeys.append(key);
+            m_docTokens.append(QStringList());
+        }
+        m_docByKey.insert(key, doc);
+    }
+
+    const QStringList &previous = m_docTokens[doc];
+    QStringList removed;
+    QStringList added;
+    std::set_difference(previous.begin(), previous.end(), tokens.begin(), tokens.end(),
+                        std::back_inserter(removed));
+    std::set_difference(tokens.begin(), tokens.end(), previous.begin(), previous.end(),
+                        std::back_inserter(added));
+    for (const QString &token : std::as_const(removed)) {
+        auto it = m_postings.find(token);
+        if (it == m_postings.end()) {
+            continue;
+        }
+        eraseSorted(it.value(), doc);
+        if (it.value().isEmpty()) {
+            m_postings.erase(it);
+        }
+    }
+    for (const QString &token : std::as_const(added)) {
+        insertSorted(m_postings[token], doc);
+    }
+    m_docTokens[doc] = tokens;
+}
+
+void SearchIndex::removeDocument(int key) {
+    const int doc = m_docByKey.value(key, -1);
+    if (doc < 0) {
+        return;
+    }
+    setDocument(key, {});
+    m_docByKey.remove(key);
+    m_docKeys[doc] = -1;
+    m_freeDocs.append(doc);
+}
+
+QSet<int> SearchIndex::query(const QString &text) const {
+    QSet<int> out;
+    const QStringList terms = tokenize(text);
+    if (terms.isEmpty()) {
+        return out;
+    }
+
+    QList<QVector<int>> lists;
+    lists.reserve(terms.size());
+    for (const QString &term : terms) {
+        QVector<int> docs = postingsForPrefix(term);
+        if (docs.isEmpty()) {
+            return out;
+        }
+        lists.append(std::move(docs));
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> &a, const QVector<int> &b) {
+        return a.size() < b.size();
+    });
+
+    QVector<int> matched = lists.first();
+    for (int i = 1; i < lists.size() && !matched.isEmpty(); ++i) {
+        QVector<int> next;
+        std::set_intersection(matched.begin(), matched.end(), lists[i].begin(), lists[i].end(),
+                              std::back_inserter(next));
+        matched = std::move(next);
+    }
+
+    out.reserve(matched.size());
+    for (const int doc : std::as_const(matched)) {
+        out.insert(m_docKeys[doc]);
+    }
+    return out;
+}
+
+int SearchIndex::documentCount() const {
+    return m_docByKey.size();
+}
+
+QVector<int> SearchIndex::postingsForPrefix(const QString &prefix) const {
+    auto it = m_postings.lowerBound(prefix);
+    if (it == m_postings.end() || !it.key().startsWith(prefix)) {
+        return {};
+    }
+    auto next = std::next(it);
+    if (next == m_postings.end() || !next.key().startsWith(prefix)) {
+        return it.value();
+    }
+
+    QVector<int> docs;
+    for (; it != m_postings.end() && it.key().startsWith(prefix); ++it) {
+        docs += it.value();
+    }
+    std::sort(docs.begin(), docs.end());
+    docs.erase(std::unique(docs.begin(), docs.end()), docs.end());
+    return docs;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "audioitemwidget.h"
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Documents are keyed by an int the caller chooses; build() uses each
+// track's position in the list.
+class SearchIndex {
+public:
+    static SearchIndex build(const QList<TrackData> &tracks);
+    static QStringList searchableTexts(const TrackData &track);
+    static QStringList tokenize(const QString &text);
+
+    void clear();
+    void setDocument(int key, const QStringList &texts);
+    void removeDocument(int key);
+    QSet<int> query(const QString &text) const;
+    int documentCount() const;
+
+private:
+    QVector<int> postingsForPrefix(const QString &prefix) const;
+
+    QHash<int, int> m_docByKey;
+    QVector<int> m_docKeys;
+    QVector<QStringList> m_docTokens;
+    QVector<int> m_freeDocs;
+    QMap<QString, QVector<int>> m_postings;
+};
@@ -0,0 +1,179 @@
+#include "shardexport.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+struct HashedTrack {
+    quint64 hash = 0;
+    int index = 0;
+};
+
+struct ShardFile {
+    QString path;
+    QList<int> rows;
+};
+
+quint64 idHash(const QString &id) {
+    const QByteArray digest = QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Sha1);
+    return qFromBigEndian<quint64>(digest.constData());
+}
+
+QString durationBucket(int seconds) {
+    if (seconds <= 0) {
+        return QStringLiteral("unknown");
+    }
+    if (seconds < 30) {
+        return QStringLiteral("<30s");
+    }
+    if (seconds < 60) {
+        return QStringLiteral("30-60s");
+    }
+    if (seconds < 120) {
+        return QStringLiteral("1-2min");
+    }
+    if (seconds < 240) {
+        return QStringLiteral("2-4min");
+    }
+    return QStringLiteral("4min+");
+}
+
+bool writeShardFile(const DatasetMetadata &meta, const QList<TrackData> &tracks, const ShardFile &file,
+                    bool jsonl, QString *error) {
+    if (jsonl) {
+        JsonlDatasetWriter writer;
+        if (!writer.open(file.path, meta, static_cast<int>(file.rows.size()), error)) {
+            return false;
+        }
+        for (const int row : file.rows) {
+            if (!writer.write(tracks[row])) {
+                break;
+            }
+        }
+        return writer.commit(error);
+    }
+    QList<TrackData> subset;
+    subset.reserve(file.rows.size());
+    for (const int row : file.rows) {
+        subset.append(tracks[row]);
+    }
+    QSaveFile out(file.path);
+    const QByteArray bytes = buildOrderedJson(meta, subset);
+    if (!out.open(QIODevice::WriteOnly) || out.write(bytes) != bytes.size() || !out.commit()) {
+        *error = out.errorString();
+        return false;
+    }
+    return true;
+}
+}
+
+QString shardStratumKey(const TrackData &track, ShardStratum stratum) {
+    switch (stratum) {
+    case ShardStratum::Genre: {
+        // Multi-genre entries are grouped by the first, main genre.
+        const QString first = track.genre.section(QLatin1Char(','), 0, 0).trimmed().toLower();
+        return first.isEmpty() ? QStringLiteral("(none)") : first;
+    }
+    case ShardStratum::Language:
+        return track.language.trimmed().toLower();
+    case ShardStratum::Duration:
+        return durationBucket(track.duration);
+    case ShardStratum::None:
+        break;
+    }
+    return QString();
+}
+
+ShardPlan planShards(const QList<TrackData> &tracks, const ShardExportOptions &options) {
+    QMap<QString, QList<HashedTrack>> strata;
+    for (int i = 0; i < tracks.size(); ++i) {
+        strata[shardStratumKey(tracks[i], options.stratum)].append({idHash(tracks[i].id), i});
+    }
+
+    ShardPlan plan;
+    QList<int> train;
+    train.reserve(tracks.size());
+    // A fixed cut on the hash rather than a share of each stratum's ranks,
+    // so adding tracks never moves an existing one between the splits.
+    const double fraction = std::clamp(options.validationFraction, 0.0, 1.0);
+    const quint64 threshold = fraction >= 1.0 ? 0 : static_cast<quint64>(std::ldexp(fraction, 64));
+    for (QList<HashedTrack> &group : strata) {
+        std::sort(group.begin(), group.end(), [](const HashedTrack &a, const HashedTrack &b) {
+            return a.hash != b.hash ? a.hash < b.hash : a.index < b.index;
+        });
+        for (const HashedTrack &track : std::as_const(group)) {
+            const bool held = fraction >= 1.0 || track.hash < threshold;
+            (held ? plan.validation : train).append(track.index);
+        }
+    }
+
+    // One running counter across strata keeps the shard sizes within one
+    // of each other.
+    const int shardCount = std::clamp(options.shardCount, 1, std::max(1, static_cast<int>(train.size())));
+    plan.trainShards.resize(shardCount);
+    for (int i = 0; i < train.size(); ++i) {
+        plan.trainShards[i % shardCount].append(train[i]);
+    }
+    return plan;
+}
+
+bool exportShards(const DatasetMetadata &meta, const QList<TrackData> &tracks, const ShardExportOptions &options,
+                  QStringList *written, QString *error) {
+    const auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    if (tracks.isEmpty()) {
+        return fail(QStringLiteral("The dataset has no tracks"));
+    }
+    const QDir dir(options.outputDir);
+    if (!dir.exists() && !QDir().mkpath(options.outputDir)) {
+        return fail(QStringLiteral("Cannot create %1").arg(options.outputDir));
+    }
+
+    const ShardPlan plan = planShards(tracks, options);
+    const QString suffix = options.jsonl ? QStringLiteral(".jsonl") : QStringLiteral(".json");
+    QList<ShardFile> files;
+    const int shardCount = static_cast<int>(plan.trainShards.size());
+    for (int i = 0; i < shardCount; ++i) {
+        if (plan.trainShards[i].isEmpty()) {
+            continue;
+        }
+        files.append({dir.filePath(QStringLiteral("%1-train-%2-of-%3%4")
+                                       .arg(options.baseName)
+                                       .arg(i, 5, 10, QLatin1Char('0'))
+                                       .arg(shardCount, 5, 10, QLatin1Char('0'))
+                                       .arg(suffix)),
+                      plan.trainShards[i]});
+    }
+    if (!plan.validation.isEmpty()) {
+        files.append({dir.filePath(options.baseName + QStringLiteral("-validation") + suffix), plan.validation});
+    }
+
+    const QStringList errors = QtConcurrent::blockingMapped<QStringList>(files, [&](const ShardFile &file) {
+        QString message;
+        if (!writeShardFile(meta, tracks, file, options.jsonl, &message)) {
+            return QStringLiteral("%1: %2").arg(QFileInfo(file.path).fileName(), message);
+        }
+        return QString();
+    });
+    for (const QString &message : errors) {
+        if (!message.isEmpty()) {
+            return fail(message);
+        }
+    }
+    written->clear();
+    for (const ShardFile &file : std::as_const(files)) {
+        written->append(file.path);
+    }
+    return true;
+}
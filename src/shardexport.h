@@ -0,0 +1,41 @@
+#pragma once
+
+#include "datasetio.h"
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+enum class ShardStratum {
+    None,
+    Genre,
+    Language,
+    Duration,
+};
+
+struct ShardExportOptions {
+    QString outputDir;
+    QString baseName = "dataset";
+    int shardCount = 4;
+    // Expected share held out for validation; 0 writes no split.
+    double validationFraction = 0.1;
+    ShardStratum stratum = ShardStratum::None;
+    bool jsonl = true;
+};
+
+// Indices into the exported track list.
+struct ShardPlan {
+    QList<QList<int>> trainShards;
+    QList<int> validation;
+};
+
+// A track is held out for validation when the SHA-1 of its id falls below
+// validationFraction of the hash range, so it stays in the same split however
+// the dataset is sorted or grown. Each stratum then gets about that share.
+// Inside each stratum the rest is ordered by hash and dealt round-robin over
+// the shards, which keeps each shard's mix of strata close to the whole.
+ShardPlan planShards(const QList<TrackData> &tracks, const ShardExportOptions &options);
+QString shardStratumKey(const TrackData &track, ShardStratum stratum);
+// Writes the planned files concurrently, one task per file.
+bool exportShards(const DatasetMetadata &meta, const QList<TrackData> &tracks, const ShardExportOptions &options,
+                  QStringList *written, QString *error = nullptr);
@@ -0,0 +1,206 @@
+#include "spectrogramcache.h"
+
+#include "audiodecode.h"
+#include "fft.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int kSampleRate = 11025;
+constexpr qint64 kMaxDurationMs = 15 * 60 * 1000;
+constexpr int kFrameSize = 1024;
+constexpr int kMinHop = 128;
+constexpr int kMaxColumns = 2400;
+constexpr int kRows = 160;
+constexpr double kMinHz = 60.0;
+constexpr double kMaxHz = 5000.0;
+constexpr double kRangeDb = 80.0;
+constexpr int kMemoryBudgetBytes = 32 * 1024 * 1024;
+constexpr qint64 kRecheckMs = 2000;
+const char *const kDurationKey = "duration_ms";
+
+QVector<QRgb> colorTable() {
+    // Dark blue -> purple -> orange -> pale yellow, readable on the dark theme.
+    const QColor stops[] = {QColor(12, 14, 24), QColor(58, 24, 102), QColor(168, 52, 112),
+                            QColor(240, 128, 52), QColor(252, 236, 160)};
+    constexpr int stopCount = sizeof(stops) / sizeof(stops[0]);
+    QVector<QRgb> table(256);
+    for (int i = 0; i < 256; ++i) {
+        const double t = i / 255.0 * (stopCount - 1);
+        const int a = std::min(static_cast<int>(t), stopCount - 2);
+        const double f = t - a;
+        const QColor &c0 = stops[a];
+        const QColor &c1 = stops[a + 1];
+        table[i] = qRgb(qRound(c0.red() + (c1.red() - c0.red()) * f),
+                        qRound(c0.green() + (c1.green() - c0.green()) * f),
+                        qRound(c0.blue() + (c1.blue() - c0.blue()) * f));
+    }
+    return table;
+}
+
+QImage computeSpectrogram(const QString &audioPath) {
+    AudioDecodeOptions options;
+    options.sampleRate = kSampleRate;
+    options.channelCount = 1;
+    options.maxDurationMs = kMaxDurationMs;
+    QVector<float> mono;
+    if (!decodeAudioFile(audioPath, options, &mono) || mono.size() < kFrameSize) {
+        return QImage();
+    }
+
+    const qsizetype usable = mono.size() - kFrameSize;
+    const int hop = static_cast<int>(std::max<qsizetype>(kMinHop, usable / kMaxColumns + 1));
+    const int columns = static_cast<int>(usable / hop + 1);
+
+    RealFft fft(kFrameSize);
+    QVector<int> rowFirst(kRows);
+    QVector<int> rowLast(kRows);
+    for (int r = 0; r < kRows; ++r) {
+        const double lo = kMinHz * std::pow(kMaxHz / kMinHz, static_cast<double>(r) / kRows);
+        const double hi = kMinHz * std::pow(kMaxHz / kMinHz, static_cast<double>(r + 1) / kRows);
+        rowFirst[r] = std::clamp(static_cast<int>(lo * kFrameSize / kSampleRate), 1, fft.binCount() - 1);
+        rowLast[r] = std::clamp(static_cast<int>(hi * kFrameSize / kSampleRate), rowFirst[r], fft.binCount() - 1);
+    }
+
+    // Column-major dB values first so the image can be scaled to the
+    // loudest cell of this track.
+    QVector<float> db(static_cast<qsizetype>(columns) * kRows);
+    QVector<float> power(fft.binCount());
+    float loudest = -1000.0f;
+    for (int c = 0; c < columns; ++c) {
+        fft.powerSpectrum(mono.constData() + static_cast<qsizetype>(c) * hop, power.data());
+        float *column = db.data() + static_cast<qsizetype>(c) * kRows;
+        for (int r = 0; r < kRows; ++r) {
+            float peak = 0.0f;
+            for (int k = rowFirst[r]; k <= rowLast[r]; ++k) {
+                peak = std::max(peak, power[k]);
+            }
+            column[r] = 10.0f * std::log10(peak + 1e-12f);
+            loudest = std::max(loudest, column[r]);
+        }
+    }
+
+    QImage image(columns, kRows, QImage::Format_Indexed8);
+    image.setColorTable(colorTable());
+    for (int r = 0; r < kRows; ++r) {
+        uchar *line = image.scanLine(kRows - 1 - r);
+        for (int c = 0; c < columns; ++c) {
+            const float rel = (db[static_cast<qsizetype>(c) * kRows + r] - loudest + kRangeDb) / kRangeDb;
+            line[c] = static_cast<uchar>(std::clamp(rel, 0.0f, 1.0f) * 255.0f);
+        }
+    }
+    image.setText(QLatin1String(kDurationKey), QString::number(mono.size() * 1000LL / kSampleRate));
+    return image;
+}
+}
+
+SpectrogramCache *SpectrogramCache::instance() {
+    static QPointer<SpectrogramCache> cache;
+    if (!cache) {
+        cache = new SpectrogramCache(qApp);
+    }
+    return cache;
+}
+
+SpectrogramCache::SpectrogramCache(QObject *parent) : QObject(parent) {
+    m_memory.setMaxCost(kMemoryBudgetBytes);
+    m_clock.start();
+    // One worker: spectrograms are only wanted for the card being edited.
+    m_pool.setMaxThreadCount(1);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        m_pool.clear();
+        m_pool.waitForDone();
+    });
+}
+
+const QImage *SpectrogramCache::image(const QString &audioPath, QWidget *requester) {
+    if (audioPath.isEmpty()) {
+        return nullptr;
+    }
+    if (Entry *cached = m_memory.object(audioPath)) {
+        if (isCurrent(audioPath, *cached)) {
+            return &cached->image;
+        }
+        m_memory.remove(audioPath);
+    }
+    const auto failed = m_failed.find(audioPath);
+    if (failed != m_failed.end()) {
+        if (isCurrent(audioPath, *failed)) {
+            return nullptr;
+        }
+        m_failed.erase(failed);
+    }
+
+    auto waiters = m_waiters.find(audioPath);
+    const bool queued = waiters != m_waiters.end();
+    if (!queued) {
+        waiters = m_waiters.insert(audioPath, {});
+    }
+    if (requester && !waiters.value().contains(requester)) {
+        waiters.value().append(requester);
+    }
+    if (queued) {
+        return nullptr;
+    }
+
+    m_pool.start(
+        [this, audioPath]() {
+            const AudioFileStamp stamp = audioFileStamp(audioPath);
+            const QString cacheFile = audioCacheFilePath(QStringLiteral("spectrograms"), audioPath,
+                                                         QStringLiteral(".png"));
+            QImage result(cacheFile, "PNG");
+            if (result.isNull() || result.text(QLatin1String(kDurationKey)).isEmpty()) {
+                result = computeSpectrogram(audioPath);
+                if (!result.isNull()) {
+                    QSaveFile file(cacheFile);
+                    if (file.open(QIODevice::WriteOnly) && result.save(&file, "PNG")) {
+                        file.commit();
+                    }
+                }
+            }
+            QMetaObject::invokeMethod(
+                this, [this, audioPath, result, stamp]() { finishJob(audioPath, result, stamp); },
+                Qt::QueuedConnection);
+        },
+        ++m_requestSerial);
+    return nullptr;
+}
+
+bool SpectrogramCache::hasFailed(const QString &audioPath) const {
+    return m_failed.contains(audioPath);
+}
+
+void SpectrogramCache::retry(const QString &audioPath) {
+    m_memory.remove(audioPath);
+    m_failed.remove(audioPath);
+}
+
+bool SpectrogramCache::isCurrent(const QString &audioPath, Entry &entry) {
+    const qint64 now = m_clock.elapsed();
+    if (now - entry.checkedMs < kRecheckMs) {
+        return true;
+    }
+    entry.checkedMs = now;
+    return audioFileStamp(audioPath) == entry.stamp;
+}
+
+void SpectrogramCache::finishJob(const QString &audioPath, const QImage &image, const AudioFileStamp &stamp) {
+    const QList<QPointer<QWidget>> waiters = m_waiters.take(audioPath);
+    if (image.isNull()) {
+        m_failed.insert(audioPath, {QImage(), stamp, m_clock.elapsed()});
+    } else {
+        m_memory.insert(audioPath, new Entry{image, stamp, m_clock.elapsed()},
+                        std::max<qsizetype>(1, image.sizeInBytes()));
+    }
+    // Waiters are repainted either way so a failure replaces the progress text.
+    for (const QPointer<QWidget> &widget : waiters) {
+        if (widget) {
+            widget->update();
+        }
+    }
+}
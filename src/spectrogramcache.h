@@ -0,0 +1,53 @@
+#pragma once
+
+#include "audiodecode.h"
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QWidget>
+
+class SpectrogramCache : public QObject {
+    Q_OBJECT
+
+public:
+    static SpectrogramCache *instance();
+
+    // Same contract as WaveformCache::peaks(): nullptr until the image is in
+    // memory, and the requester is repainted when it arrives. The image is
+    // 8-bit indexed, time on x and log frequency on y (low at the bottom);
+    // its "duration_ms" text key holds the covered length.
+    const QImage *image(const QString &audioPath, QWidget *requester);
+    // True once the file could not be decoded; image() then stays nullptr
+    // until the file changes on disk.
+    bool hasFailed(const QString &audioPath) const;
+    // Forgets the image or failure held for the file, as WaveformCache::retry().
+    void retry(const QString &audioPath);
+
+private:
+    explicit SpectrogramCache(QObject *parent = nullptr);
+
+    // An image, or a failure when it is null, with the stamp of the file it
+    // was read from.
+    struct Entry {
+        QImage image;
+        AudioFileStamp stamp;
+        qint64 checkedMs = 0;
+    };
+
+    void finishJob(const QString &audioPath, const QImage &image, const AudioFileStamp &stamp);
+    bool isCurrent(const QString &audioPath, Entry &entry);
+
+    QCache<QString, Entry> m_memory;
+    QHash<QString, QList<QPointer<QWidget>>> m_waiters;
+    QHash<QString, Entry> m_failed;
+    QElapsedTimer m_clock;
+    QThreadPool m_pool;
+    int m_requestSerial = 0;
+};
@@ -0,0 +1,161 @@
+#include "tracing.h"
+
+#include <QAbstractEventDispatcher>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+constexpr quint64 kEventCapacity = 1u << 16;
+constexpr int kKeystrokeCapacity = 512;
+
+int currentThreadIndex() {
+    static std::atomic_int nextIndex{1};
+    thread_local const int index = nextIndex.fetch_add(1);
+    return index;
+}
+
+void appendJsonString(QByteArray &out, const char *text) {
+    out += '"';
+    for (const char *c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += *c;
+    }
+    out += '"';
+}
+
+class KeystrokeLatencyMonitor : public QObject {
+public:
+    explicit KeystrokeLatencyMonitor(QObject *parent) : QObject(parent) {}
+
+    void onAboutToBlock() {
+        if (m_pendingStartNs < 0) {
+            return;
+        }
+        Tracer::instance().addKeystrokeLatency(Tracer::now() - m_pendingStartNs);
+        m_pendingStartNs = -1;
+    }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        // Auto-repeat and fast typing can queue several presses; the first
+        // one still waiting is the one the user is waiting on.
+        if (event->type() == QEvent::KeyPress && m_pendingStartNs < 0 && Tracer::instance().isEnabled()) {
+            m_pendingStartNs = Tracer::now();
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    qint64 m_pendingStartNs = -1;
+};
+}
+
+Tracer &Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+qint64 Tracer::now() {
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+Tracer::Tracer() : m_events(kEventCapacity), m_keystrokes(kKeystrokeCapacity, 0) {}
+
+void Tracer::setEnabled(bool enabled) {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracer::addEvent(const char *name, qint64 startNs, qint64 endNs) {
+    const quint64 index = m_next.fetch_add(1, std::memory_order_relaxed);
+    Event &event = m_events[index & (kEventCapacity - 1)];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.thread = currentThreadIndex();
+}
+
+void Tracer::clear() {
+    m_next.store(0, std::memory_order_relaxed);
+    m_keystrokeNext = 0;
+    m_keystrokeCount = 0;
+}
+
+int Tracer::eventCount() const {
+    return static_cast<int>(std::min(m_next.load(std::memory_order_relaxed), kEventCapacity));
+}
+
+bool Tracer::exportChromeTrace(const QString &path, QString *error) const {
+    // Events written while exporting may overwrite the oldest slots; the
+    // export is a diagnostic snapshot, so that is accepted over locking the
+    // hot path.
+    const quint64 end = m_next.load(std::memory_order_relaxed);
+    const quint64 begin = end > kEventCapacity ? end - kEventCapacity : 0;
+    QByteArray out;
+    out.reserve(static_cast<qsizetype>((end - begin) * 96 + 64));
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (quint64 i = begin; i < end; ++i) {
+        const Event &event = m_events[i & (kEventCapacity - 1)];
+        if (!event.name) {
+            continue;
+        }
+        if (!first) {
+            out += ",\n";
+        }
+        first = false;
+        out += "{\"name\":";
+        appendJsonString(out, event.name);
+        out += ",\"cat\":\"app\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+        out += QByteArray::number(event.thread);
+        out += ",\"ts\":";
+        out += QByteArray::number(event.startNs / 1000.0, 'f', 3);
+        out += ",\"dur\":";
+        out += QByteArray::number(event.durationNs / 1000.0, 'f', 3);
+        out += '}';
+    }
+    out += "\n]}\n";
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+void Tracer::addKeystrokeLatency(qint64 latencyNs) {
+    m_keystrokes[m_keystrokeNext] = latencyNs;
+    m_keystrokeNext = (m_keystrokeNext + 1) % kKeystrokeCapacity;
+    m_keystrokeCount = std::min(m_keystrokeCount + 1, kKeystrokeCapacity);
+}
+
+QVector<qint64> Tracer::keystrokeLatencies() const {
+    QVector<qint64> out;
+    out.reserve(m_keystrokeCount);
+    const int first = (m_keystrokeNext - m_keystrokeCount + kKeystrokeCapacity) % kKeystrokeCapacity;
+    for (int i = 0; i < m_keystrokeCount; ++i) {
+        out.append(m_keystrokes[(first + i) % kKeystrokeCapacity]);
+    }
+    return out;
+}
+
+void installKeystrokeLatencyMonitor(QCoreApplication *app) {
+    auto *monitor = new KeystrokeLatencyMonitor(app);
+    app->installEventFilter(monitor);
+    if (QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(app->thread())) {
+        QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, monitor,
+                         [monitor]() { monitor->onAboutToBlock(); });
+    }
+}
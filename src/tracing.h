@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <vector>
+
+class QCoreApplication;
+
+// Process-wide trace recorder. Completed scopes go into a fixed ring of the
+// most recent events, so recording costs two clock reads and one slot write
+// and memory stays flat no matter how long the app runs.
+class Tracer {
+public:
+    static Tracer &instance();
+    static qint64 now();
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    void addEvent(const char *name, qint64 startNs, qint64 endNs);
+    void clear();
+    int eventCount() const;
+    // Chrome trace-event JSON, loadable in chrome://tracing or Perfetto.
+    bool exportChromeTrace(const QString &path, QString *error = nullptr) const;
+
+    // Main thread only.
+    void addKeystrokeLatency(qint64 latencyNs);
+    QVector<qint64> keystrokeLatencies() const;
+
+private:
+    struct Event {
+        const char *name = nullptr;
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        int thread = 0;
+    };
+
+    Tracer();
+
+    std::atomic_bool m_enabled{true};
+    std::atomic<quint64> m_next{0};
+    std::vector<Event> m_events;
+    QVector<qint64> m_keystrokes;
+    int m_keystrokeNext = 0;
+    int m_keystrokeCount = 0;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char *name)
+        : m_name(name), m_startNs(Tracer::instance().isEnabled() ? Tracer::now() : -1) {}
+    ~TraceScope() {
+        if (m_startNs >= 0) {
+            Tracer::instance().addEvent(m_name, m_startNs, Tracer::now());
+        }
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_startNs;
+};
+
+#define TRACE_SCOPE_JOIN_INNER(a, b) a##b
+#define TRACE_SCOPE_JOIN(a, b) TRACE_SCOPE_JOIN_INNER(a, b)
+// name must be a string literal (or otherwise outlive the trace buffer).
+#define TRACE_SCOPE(name) TraceScope TRACE_SCOPE_JOIN(traceScope_, __LINE__)(name)
+
+// Measures each key press from its arrival until the event loop next goes
+// idle, which covers the edit, the layout it triggers and the repaint.
+void installKeystrokeLatencyMonitor(QCoreApplication *app);
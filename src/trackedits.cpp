@@ -0,0 +1,97 @@
+#include "trackedits.h"
+#include "audioitemwidget.h"
+
+#include <utility>
+
+QStringList undoableTrackFields() {
+    return {"caption",  "genre",    "lyrics",   "bpm",
+            "keyscale", "timesignature", "duration", "language",
+            "is_instrumental", "prompt_override", "audio_path"};
+}
+
+QStringList trackLanguages() {
+    return {"instrumental", "en", "zh", "ja", "ko", "es", "fr", "de", "pt", "ru"};
+}
+
+QString trackFieldValue(const TrackData &track, const QString &field) {
+    if (field == QLatin1String("caption")) {
+        return track.caption;
+    }
+    if (field == QLatin1String("genre")) {
+        return track.genre;
+    }
+    if (field == QLatin1String("lyrics")) {
+        return track.lyrics;
+    }
+    if (field == QLatin1String("bpm")) {
+        return QString::number(track.bpm);
+    }
+    if (field == QLatin1String("keyscale")) {
+        return track.keyscale;
+    }
+    if (field == QLatin1String("timesignature")) {
+        return track.timesignature;
+    }
+    if (field == QLatin1String("duration")) {
+        return QString::number(track.duration);
+    }
+    if (field == QLatin1String("language")) {
+        return track.language;
+    }
+    if (field == QLatin1String("is_instrumental")) {
+        return track.isInstrumental ? QStringLiteral("true") : QStringLiteral("false");
+    }
+    if (field == QLatin1String("prompt_override")) {
+        return track.promptOverride;
+    }
+    if (field == QLatin1String("audio_path")) {
+        return track.audioPath;
+    }
+    return QString();
+}
+
+TrackEditCommand::TrackEditCommand(const QString &text, QList<CardFieldEdit> edits, ApplyFn apply)
+    : m_edits(std::move(edits)), m_apply(std::move(apply)) {
+    setText(text);
+}
+
+void TrackEditCommand::undo() {
+    m_apply(m_edits, true);
+}
+
+void TrackEditCommand::redo() {
+    if (m_skipNextRedo) {
+        m_skipNextRedo = false;
+        return;
+    }
+    m_apply(m_edits, false);
+}
+
+int TrackEditCommand::editCount() const {
+    return m_edits.size();
+}
+
+void TrackEditCommand::setAlreadyApplied(bool applied) {
+    m_skipNextRedo = applied;
+}
+
+TrackMoveCommand::TrackMoveCommand(const QString &text, CardOrder before, CardOrder after, ApplyFn apply)
+    : m_before(std::move(before)), m_after(std::move(after)), m_apply(std::move(apply)) {
+    setText(text);
+}
+
+void TrackMoveCommand::undo() {
+    m_apply(m_before, true);
+}
+
+void TrackMoveCommand::redo() {
+    if (m_skipNextRedo) {
+        m_skipNextRedo = false;
+        return;
+    }
+    m_apply(m_after, false);
+}
+
+void TrackMoveCommand::setAlreadyApplied(bool applied) {
+    m_skipNextRedo = applied;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QUndoCommand>
+
+#include <functional>
+
+class AudioItemWidget;
+struct TrackData;
+
+struct CardFieldEdit {
+    QPointer<AudioItemWidget> card;
+    QString field;
+    QString before;
+    QString after;
+};
+
+QStringList undoableTrackFields();
+// The values the language field can take.
+QStringList trackLanguages();
+QString trackFieldValue(const TrackData &track, const QString &field);
+
+class TrackEditCommand : public QUndoCommand {
+public:
+    using ApplyFn = std::function<void(const QList<CardFieldEdit> &edits, bool undo)>;
+
+    TrackEditCommand(const QString &text, QList<CardFieldEdit> edits, ApplyFn apply);
+
+    void undo() override;
+    void redo() override;
+    int editCount() const;
+    void setAlreadyApplied(bool applied);
+
+private:
+    QList<CardFieldEdit> m_edits;
+    ApplyFn m_apply;
+    bool m_skipNextRedo = false;
+};
+
+// Switches the cards between the order before a move and after it.
+class TrackMoveCommand : public QUndoCommand {
+public:
+    using CardOrder = QList<QPointer<AudioItemWidget>>;
+    using ApplyFn = std::function<void(const CardOrder &order, bool undo)>;
+
+    TrackMoveCommand(const QString &text, CardOrder before, CardOrder after, ApplyFn apply);
+
+    void undo() override;
+    void redo() override;
+    void setAlreadyApplied(bool applied);
+
+private:
+    CardOrder m_before;
+    CardOrder m_after;
+    ApplyFn m_apply;
+    bool m_skipNextRedo = false;
+};
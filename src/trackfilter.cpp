@@ -0,0 +1,267 @@
+#include "trackfilter.h"
+
+#include <QFileInfo>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+bool isNumericField(TrackSortField field) {
+    return field == TrackSortField::Bpm || field == TrackSortField::Duration ||
+           field == TrackSortField::Instrumental || field >= TrackSortField::Loudness;
+}
+
+bool inRange(double value, const TrackFilter &filter) {
+    return value >= filter.minValue && value <= filter.maxValue;
+}
+
+template <typename List>
+void removeIndices(List &list, const QSet<int> &rows) {
+    int out = 0;
+    for (int i = 0; i < list.size(); ++i) {
+        if (rows.contains(i)) {
+            continue;
+        }
+        if (out != i) {
+            list[out] = std::move(list[i]);
+        }
+        ++out;
+    }
+    list.resize(out);
+}
+
+template <typename List>
+void permute(List &list, const QVector<int> &order) {
+    List out;
+    out.reserve(list.size());
+    for (const int row : order) {
+        out.append(std::move(list[row]));
+    }
+    list = std::move(out);
+}
+}
+
+bool TrackFilter::parseRange(const QString &text, double *minValue, double *maxValue) {
+    const QString t = text.trimmed();
+    double lo = -std::numeric_limits<double>::infinity();
+    double hi = std::numeric_limits<double>::infinity();
+    if (t.isEmpty()) {
+        *minValue = lo;
+        *maxValue = hi;
+        return true;
+    }
+    const int dash = t.indexOf('-', 1);
+    bool ok = true;
+    if (dash < 0) {
+        lo = hi = t.toDouble(&ok);
+    } else {
+        const QString left = t.left(dash).trimmed();
+        const QString right = t.mid(dash + 1).trimmed();
+        bool okLeft = true;
+        bool okRight = true;
+        if (!left.isEmpty()) {
+            lo = left.toDouble(&okLeft);
+        }
+        if (!right.isEmpty()) {
+            hi = right.toDouble(&okRight);
+        }
+        ok = okLeft && okRight;
+    }
+    if (!ok) {
+        return false;
+    }
+    *minValue = qMin(lo, hi);
+    *maxValue = qMax(lo, hi);
+    return true;
+}
+
+void TrackListView::setRows(const QList<TrackViewRow> &rows) {
+    m_rows = rows;
+    m_keys.clear();
+}
+
+void TrackListView::updateRow(int row, const TrackViewRow &data) {
+    if (row < 0 || row >= m_rows.size()) {
+        return;
+    }
+    m_rows[row] = data;
+    for (auto it = m_keys.begin(); it != m_keys.end(); ++it) {
+        assignKey(it.value(), row, data, static_cast<TrackSortField>(it.key()));
+    }
+}
+
+void TrackListView::removeRows(const QSet<int> &rows) {
+    if (rows.isEmpty()) {
+        return;
+    }
+    removeIndices(m_rows, rows);
+    for (auto it = m_keys.begin(); it != m_keys.end(); ++it) {
+        if (it->numeric) {
+            removeIndices(it->numbers, rows);
+        } else {
+            removeIndices(it->texts, rows);
+        }
+    }
+}
+
+void TrackListView::reorderRows(const QVector<int> &order) {
+    if (order.size() != m_rows.size()) {
+        return;
+    }
+    permute(m_rows, order);
+    for (auto it = m_keys.begin(); it != m_keys.end(); ++it) {
+        if (it->numeric) {
+            permute(it->numbers, order);
+        } else {
+            permute(it->texts, order);
+        }
+    }
+}
+
+void TrackListView::clearDirtyFlags() {
+    for (TrackViewRow &row : m_rows) {
+        row.dirty = false;
+    }
+}
+
+int TrackListView::rowCount() const {
+    return m_rows.size();
+}
+
+QVector<int> TrackListView::apply(const TrackFilter &filter, TrackSortField field, bool ascending) const {
+    QVector<int> out;
+    out.reserve(m_rows.size());
+    for (int i = 0; i < m_rows.size(); ++i) {
+        if (matches(m_rows[i], filter)) {
+            out.append(i);
+        }
+    }
+    if (field == TrackSortField::DatasetOrder) {
+        if (!ascending) {
+            std::reverse(out.begin(), out.end());
+        }
+        return out;
+    }
+
+    const SortKeys &keys = keysFor(field);
+    if (keys.numeric) {
+        std::stable_sort(out.begin(), out.end(), [&keys, ascending](int a, int b) {
+            return ascending ? keys.numbers[a] < keys.numbers[b] : keys.numbers[b] < keys.numbers[a];
+        });
+    } else {
+        std::stable_sort(out.begin(), out.end(), [&keys, ascending](int a, int b) {
+            const int cmp = QString::compare(keys.texts[a], keys.texts[b]);
+            return ascending ? cmp < 0 : cmp > 0;
+        });
+    }
+    return out;
+}
+
+bool TrackListView::matches(const TrackViewRow &row, const TrackFilter &filter) const {
+    const TrackData &t = row.data;
+    switch (filter.kind) {
+    case TrackFilterKind::All:
+        return true;
+    case TrackFilterKind::Uncaptioned:
+        return t.caption.trimmed().isEmpty();
+    case TrackFilterKind::NoLyrics:
+        return t.lyrics.trimmed().isEmpty();
+    case TrackFilterKind::Unsaved:
+        return row.dirty;
+    case TrackFilterKind::Language:
+        return filter.language.isEmpty() ||
+               t.language.compare(filter.language, Qt::CaseInsensitive) == 0;
+    case TrackFilterKind::BpmRange:
+        return inRange(t.bpm, filter);
+    case TrackFilterKind::DurationRange:
+        return inRange(t.duration, filter);
+    case TrackFilterKind::AudioIssues:
+        return !loudnessIssues(row.loudness).isEmpty();
+    }
+    return true;
+}
+
+const TrackListView::SortKeys &TrackListView::keysFor(TrackSortField field) const {
+    const int key = static_cast<int>(field);
+    auto it = m_keys.find(key);
+    if (it != m_keys.end()) {
+        return it.value();
+    }
+    SortKeys keys;
+    keys.numeric = isNumericField(field);
+    if (keys.numeric) {
+        keys.numbers.resize(m_rows.size());
+    } else {
+        keys.texts.reserve(m_rows.size());
+        for (int i = 0; i < m_rows.size(); ++i) {
+            keys.texts.append(QString());
+        }
+    }
+    for (int i = 0; i < m_rows.size(); ++i) {
+        assignKey(keys, i, m_rows[i], field);
+    }
+    return m_keys.insert(key, keys).value();
+}
+
+void TrackListView::assignKey(SortKeys &keys, int row, const TrackViewRow &viewRow, TrackSortField field) {
+    const TrackData &data = viewRow.data;
+    const LoudnessStats &loudness = viewRow.loudness;
+    // Tracks that were never analysed sort before every measured one.
+    const double unmeasured = -std::numeric_limits<double>::infinity();
+    switch (field) {
+    case TrackSortField::Bpm:
+        keys.numbers[row] = data.bpm;
+        return;
+    case TrackSortField::Duration:
+        keys.numbers[row] = data.duration;
+        return;
+    case TrackSortField::Instrumental:
+        keys.numbers[row] = data.isInstrumental ? 1.0 : 0.0;
+        return;
+    case TrackSortField::Filename:
+        keys.texts[row] = (data.filename.isEmpty() ? QFileInfo(data.audioPath).fileName() : data.filename)
+                              .toCaseFolded();
+        return;
+    case TrackSortField::Caption:
+        keys.texts[row] = data.caption.trimmed().toCaseFolded();
+        return;
+    case TrackSortField::Genre:
+        keys.texts[row] = data.genre.trimmed().toCaseFolded();
+        return;
+    case TrackSortField::Lyrics:
+        keys.texts[row] = data.lyrics.trimmed().toCaseFolded();
+        return;
+    case TrackSortField::Keyscale:
+        keys.texts[row] = data.keyscale.trimmed().toCaseFolded();
+        return;
+    case TrackSortField::TimeSignature:
+        keys.texts[row] = data.timesignature.trimmed().toCaseFolded();
+        return;
+    case TrackSortField::Language:
+        keys.texts[row] = data.language.toCaseFolded();
+        return;
+    case TrackSortField::PromptOverride:
+        keys.texts[row] = data.promptOverride.toCaseFolded();
+        return;
+    case TrackSortField::Id:
+        keys.texts[row] = data.id;
+        return;
+    case TrackSortField::Loudness:
+        keys.numbers[row] = loudness.valid ? loudness.integratedLufs : unmeasured;
+        return;
+    case TrackSortField::TruePeak:
+        keys.numbers[row] = loudness.valid ? loudness.truePeakDbtp : unmeasured;
+        return;
+    case TrackSortField::ClippedSamples:
+        keys.numbers[row] = loudness.valid ? static_cast<double>(loudness.clippedSamples) : unmeasured;
+        return;
+    case TrackSortField::LeadingSilence:
+        keys.numbers[row] = loudness.valid ? loudness.leadingSilenceSec : unmeasured;
+        return;
+    case TrackSortField::TrailingSilence:
+        keys.numbers[row] = loudness.valid ? loudness.trailingSilenceSec : unmeasured;
+        return;
+    case TrackSortField::DatasetOrder:
+        return;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "audioitemwidget.h"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+enum class TrackFilterKind {
+    All,
+    Uncaptioned,
+    NoLyrics,
+    Unsaved,
+    Language,
+    BpmRange,
+    DurationRange,
+    AudioIssues,
+};
+
+enum class TrackSortField {
+    DatasetOrder,
+    Filename,
+    Caption,
+    Genre,
+    Lyrics,
+    Bpm,
+    Keyscale,
+    TimeSignature,
+    Duration,
+    Language,
+    Instrumental,
+    PromptOverride,
+    Id,
+    Loudness,
+    TruePeak,
+    ClippedSamples,
+    LeadingSilence,
+    TrailingSilence,
+};
+
+struct TrackFilter {
+    TrackFilterKind kind = TrackFilterKind::All;
+    QString language;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+
+    static bool parseRange(const QString &text, double *minValue, double *maxValue);
+};
+
+struct TrackViewRow {
+    TrackData data;
+    bool dirty = false;
+    LoudnessStats loudness;
+};
+
+class TrackListView {
+public:
+    void setRows(const QList<TrackViewRow> &rows);
+    void updateRow(int row, const TrackViewRow &data);
+    void removeRows(const QSet<int> &rows);
+    // order[i] is the current row that becomes row i.
+    void reorderRows(const QVector<int> &order);
+    void clearDirtyFlags();
+    int rowCount() const;
+
+    QVector<int> apply(const TrackFilter &filter, TrackSortField field, bool ascending) const;
+
+private:
+    struct SortKeys {
+        bool numeric = false;
+        QVector<double> numbers;
+        QStringList texts;
+    };
+
+    bool matches(const TrackViewRow &row, const TrackFilter &filter) const;
+    const SortKeys &keysFor(TrackSortField field) const;
+    static void assignKey(SortKeys &keys, int row, const TrackViewRow &data, TrackSortField field);
+
+    QList<TrackViewRow> m_rows;
+    mutable QHash<int, SortKeys> m_keys;
+};
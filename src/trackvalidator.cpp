@@ -0,0 +1,227 @@
+#include "trackvalidator.h"
+
+#include "audiotranscode.h"
+#include "waveformcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <cmath>
+
+namespace {
+// Samples checked per task; small enough that issues arrive steadily.
+constexpr int kBatchSize = 256;
+constexpr int kMinBpm = 30;
+constexpr int kMaxBpm = 300;
+
+using FolderListing = QSet<QString>;
+
+struct Batch {
+    const FolderListing *listing = nullptr;
+    QList<int> rows;
+};
+
+// What the rules need to know about a sample beyond its fields.
+struct SampleFacts {
+    const TrackData &track;
+    bool audioFound = false;
+    // -1 when the length could not be read cheaply.
+    qint64 audioDurationMs = -1;
+};
+
+using RuleCheck = QString (*)(const SampleFacts &facts, const ValidationOptions &options);
+
+struct Rule {
+    const char *field;
+    ValidationSeverity severity;
+    // Returns the message for a failing sample, or an empty string.
+    RuleCheck check;
+};
+
+QString fileKey(const QString &name) {
+#ifdef Q_OS_WIN
+    return name.toLower();
+#else
+    return name;
+#endif
+}
+
+FolderListing listFolder(const QString &folder) {
+    FolderListing names;
+    if (folder.isEmpty()) {
+        return names;
+    }
+    const QStringList entries = QDir(folder).entryList(QDir::Files | QDir::Hidden | QDir::System);
+    names.reserve(entries.size());
+    for (const QString &name : entries) {
+        names.insert(fileKey(name));
+    }
+    return names;
+}
+
+qint64 flacDurationMs(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QByteArray head = file.read(10);
+    // Some taggers put an ID3v2 block in front of the stream marker.
+    if (head.size() == 10 && head.startsWith("ID3")) {
+        const auto byte = [&head](int i) { return static_cast<qint64>(static_cast<quint8>(head[i]) & 0x7f); };
+        const qint64 tagSize = (byte(6) << 21) | (byte(7) << 14) | (byte(8) << 7) | byte(9);
+        if (!file.seek(10 + tagSize)) {
+            return -1;
+        }
+    } else if (!file.seek(0)) {
+        return -1;
+    }
+    // "fLaC", then the STREAMINFO block header and its 34 bytes of data.
+    const QByteArray block = file.read(42);
+    if (block.size() != 42 || !block.startsWith("fLaC") || (static_cast<quint8>(block[4]) & 0x7f) != 0) {
+        return -1;
+    }
+    const quint64 packed = qFromBigEndian<quint64>(block.constData() + 8 + 10);
+    const qint64 sampleRate = static_cast<qint64>(packed >> 44);
+    const qint64 totalSamples = static_cast<qint64>(packed & 0xFFFFFFFFFULL);
+    return sampleRate > 0 && totalSamples > 0 ? totalSamples * 1000 / sampleRate : -1;
+}
+
+qint64 audioDurationMs(const QString &path) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == QLatin1String("wav")) {
+        const double seconds = wavDurationSeconds(path);
+        if (seconds > 0.0) {
+            return std::llround(seconds * 1000.0);
+        }
+    } else if (suffix == QLatin1String("flac")) {
+        const qint64 ms = flacDurationMs(path);
+        if (ms > 0) {
+            return ms;
+        }
+    }
+    // Compressed formats carry no exact length in a fixed header; a track
+    // whose waveform has been drawn before has it on disk.
+    return WaveformCache::cachedDurationMs(path);
+}
+
+bool isValidTimeSignature(const QString &value) {
+    const QStringList parts = value.trimmed().split(QLatin1Char('/'));
+    if (parts.size() > 2) {
+        return false;
+    }
+    bool ok = false;
+    const int beats = parts[0].toInt(&ok);
+    if (!ok || beats < 1 || beats > 16) {
+        return false;
+    }
+    if (parts.size() == 1) {
+        return true;
+    }
+    const int unit = parts[1].toInt(&ok);
+    return ok && unit >= 1 && unit <= 32 && (unit & (unit - 1)) == 0;
+}
+
+QString checkAudioFile(const SampleFacts &facts, const ValidationOptions &) {
+    if (facts.track.audioPath.trimmed().isEmpty()) {
+        return QStringLiteral("No audio file");
+    }
+    return facts.audioFound ? QString() : QStringLiteral("Audio file not found");
+}
+
+QString checkBpmSet(const SampleFacts &facts, const ValidationOptions &) {
+    return facts.track.bpm <= 0 ? QStringLiteral("BPM is not set") : QString();
+}
+
+QString checkBpmRange(const SampleFacts &facts, const ValidationOptions &) {
+    const int bpm = facts.track.bpm;
+    return bpm > 0 && (bpm < kMinBpm || bpm > kMaxBpm)
+               ? QStringLiteral("BPM %1 is outside %2-%3").arg(bpm).arg(kMinBpm).arg(kMaxBpm)
+               : QString();
+}
+
+QString checkTimeSignature(const SampleFacts &facts, const ValidationOptions &) {
+    const QString &value = facts.track.timesignature;
+    return value.trimmed().isEmpty() || isValidTimeSignature(value)
+               ? QString()
+               : QStringLiteral("\"%1\" is not a time signature").arg(value);
+}
+
+QString checkDurationSet(const SampleFacts &facts, const ValidationOptions &) {
+    return facts.track.duration <= 0 ? QStringLiteral("Duration is not set") : QString();
+}
+
+QString checkDurationMatchesAudio(const SampleFacts &facts, const ValidationOptions &options) {
+    if (facts.audioDurationMs < 0 || facts.track.duration <= 0) {
+        return QString();
+    }
+    const double audioSeconds = facts.audioDurationMs / 1000.0;
+    if (std::abs(facts.track.duration - audioSeconds) <= options.durationToleranceSeconds) {
+        return QString();
+    }
+    return QStringLiteral("Duration is %1 s but the audio is %2 s")
+        .arg(facts.track.duration)
+        .arg(audioSeconds, 0, 'f', 1);
+}
+
+const Rule kRules[] = {
+    {"audio_path", ValidationSeverity::Error, checkAudioFile},
+    {"bpm", ValidationSeverity::Error, checkBpmSet},
+    {"bpm", ValidationSeverity::Warning, checkBpmRange},
+    {"timesignature", ValidationSeverity::Error, checkTimeSignature},
+    {"duration", ValidationSeverity::Warning, checkDurationSet},
+    {"duration", ValidationSeverity::Error, checkDurationMatchesAudio},
+};
+
+void checkSample(int row, const TrackData &track, const FolderListing &listing, const ValidationOptions &options,
+                 QList<ValidationIssue> *issues) {
+    SampleFacts facts{track};
+    facts.audioFound =
+        !track.audioPath.isEmpty() && listing.contains(fileKey(QFileInfo(track.audioPath).fileName()));
+    if (facts.audioFound && options.checkAudioDuration && track.duration > 0) {
+        facts.audioDurationMs = audioDurationMs(track.audioPath);
+    }
+    for (const Rule &rule : kRules) {
+        const QString message = rule.check(facts, options);
+        if (!message.isEmpty()) {
+            issues->append({row, QString::fromLatin1(rule.field), rule.severity, message});
+        }
+    }
+}
+}
+
+int validateTracks(const QList<TrackData> &tracks, const ValidationOptions &options, const ValidationSink &sink) {
+    QHash<QString, QList<int>> rowsByFolder;
+    for (int i = 0; i < tracks.size(); ++i) {
+        const QString &path = tracks[i].audioPath;
+        rowsByFolder[path.isEmpty() ? QString() : QFileInfo(path).absolutePath()].append(i);
+    }
+
+    const QStringList folders = rowsByFolder.keys();
+    const QList<FolderListing> listings = QtConcurrent::blockingMapped<QList<FolderListing>>(folders, listFolder);
+
+    QList<Batch> batches;
+    for (int f = 0; f < folders.size(); ++f) {
+        const QList<int> &rows = rowsByFolder[folders[f]];
+        for (int start = 0; start < rows.size(); start += kBatchSize) {
+            batches.append({&listings[f], rows.mid(start, kBatchSize)});
+        }
+    }
+
+    std::atomic_int checked{0};
+    QtConcurrent::blockingMap(batches, [&](const Batch &batch) {
+        if (options.cancel && options.cancel->load()) {
+            return;
+        }
+        QList<ValidationIssue> issues;
+        for (const int row : batch.rows) {
+            checkSample(row, tracks[row], *batch.listing, options, &issues);
+        }
+        checked += static_cast<int>(batch.rows.size());
+        sink(issues, static_cast<int>(batch.rows.size()));
+    });
+    return checked.load();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "audioitemwidget.h"
+
+#include <QList>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+
+enum class ValidationSeverity {
+    Warning,
+    Error,
+};
+
+struct ValidationIssue {
+    // Index into the validated list.
+    int row = 0;
+    QString field;
+    ValidationSeverity severity = ValidationSeverity::Error;
+    QString message;
+};
+
+struct ValidationOptions {
+    // Compares the duration field with the length read from the audio
+    // file's header (WAV and FLAC, or a cached waveform for other formats).
+    // This opens one file per sample that has a duration.
+    bool checkAudioDuration = true;
+    int durationToleranceSeconds = 2;
+    // Polled between batches.
+    const std::atomic_bool *cancel = nullptr;
+};
+
+// Called from worker threads once per batch, with that batch's issues and
+// the number of samples it checked.
+using ValidationSink = std::function<void(const QList<ValidationIssue> &issues, int checked)>;
+
+// Runs every rule over every track on the global thread pool. Each folder
+// holding audio is listed once and the listing answers the file-existence
+// checks of all samples in it, instead of a stat per sample; only the
+// duration check goes to the files themselves. Blocks until done and
+// returns the number of samples checked.
+int validateTracks(const QList<TrackData> &tracks, const ValidationOptions &options, const ValidationSink &sink);
@@ -0,0 +1,188 @@
+#include "vocaldetector.h"
+
+#include "audiodecode.h"
+#include "fft.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+constexpr int kAnalysisSampleRate = 16000;
+constexpr qint64 kMaxAnalysisMs = 180000;
+constexpr int kFrameSize = 1024;
+constexpr int kHopSize = 512;
+constexpr double kMinFrequency = 60.0;
+constexpr double kVoiceLow = 300.0;
+constexpr double kVoiceHigh = 3400.0;
+constexpr double kMaxFrequency = 7000.0;
+constexpr int kMotionRadius = 5;
+constexpr int kSmoothRadius = 15;
+constexpr double kSilenceDb = -45.0;
+// Below this share of vocal frames a track is proposed as instrumental.
+constexpr double kVocalFractionThreshold = 0.12;
+constexpr int kMinAudibleFrames = 40;
+
+constexpr int kFeatureCount = 4;
+
+// Logistic model over per-frame features, each standardised as
+// (x - mean) / scale. The weights are hand-set from the typical range of
+// each feature rather than fitted: vocals put most of their energy in the
+// voice band, are harmonic (low flatness), move their formants (centroid
+// motion) and start notes with consonants (flux).
+struct FeatureWeight {
+    double mean;
+    double scale;
+    double weight;
+};
+constexpr std::array<FeatureWeight, kFeatureCount> kWeights = {{
+    {0.55, 0.15, 1.4},   // voice-band energy ratio
+    {0.30, 0.12, -1.0},  // voice-band spectral flatness
+    {120.0, 60.0, 1.5},  // voice-band centroid motion, Hz
+    {0.35, 0.15, 0.6},   // voice-band positive flux, relative
+}};
+constexpr double kBias = -0.4;
+
+struct FrameFeatures {
+    std::array<double, kFeatureCount> x{};
+    double centroid = 0.0;
+    double energyDb = -200.0;
+};
+
+double logistic(double z) {
+    return 1.0 / (1.0 + std::exp(-z));
+}
+}
+
+VocalEstimate estimateVocals(const QVector<float> &mono, int sampleRate) {
+    VocalEstimate out;
+    if (sampleRate <= 0 || mono.size() < kFrameSize) {
+        return out;
+    }
+
+    RealFft fft(kFrameSize);
+    const double binHz = static_cast<double>(sampleRate) / kFrameSize;
+    const int firstBin = std::max(1, static_cast<int>(std::ceil(kMinFrequency / binHz)));
+    const int voiceFirst = static_cast<int>(std::ceil(kVoiceLow / binHz));
+    const int voiceLast = static_cast<int>(std::floor(kVoiceHigh / binHz));
+    const int lastBin = std::min(fft.binCount() - 1, static_cast<int>(std::floor(kMaxFrequency / binHz)));
+
+    const int frameCount = static_cast<int>((mono.size() - kFrameSize) / kHopSize + 1);
+    QVector<FrameFeatures> frames(frameCount);
+    QVector<float> power(fft.binCount());
+    QVector<float> magnitude(fft.binCount(), 0.0f);
+    double loudestDb = -200.0;
+    for (int f = 0; f < frameCount; ++f) {
+        fft.powerSpectrum(mono.constData() + static_cast<qsizetype>(f) * kHopSize, power.data());
+        double total = 0.0;
+        double voice = 0.0;
+        double logSum = 0.0;
+        double weighted = 0.0;
+        double flux = 0.0;
+        double magSum = 0.0;
+        for (int k = firstBin; k <= lastBin; ++k) {
+            total += power[k];
+            const float mag = std::sqrt(power[k]);
+            if (k >= voiceFirst && k <= voiceLast) {
+                voice += power[k];
+                logSum += std::log(power[k] + 1e-12);
+                weighted += power[k] * k * binHz;
+                flux += std::max(0.0f, mag - magnitude[k]);
+                magSum += mag;
+            }
+            magnitude[k] = mag;
+        }
+        FrameFeatures &frame = frames[f];
+        const int voiceBins = voiceLast - voiceFirst + 1;
+        frame.energyDb = 10.0 * std::log10(total + 1e-12);
+        loudestDb = std::max(loudestDb, frame.energyDb);
+        frame.x[0] = total > 0.0 ? voice / total : 0.0;
+        frame.x[1] = voice > 0.0 ? std::exp(logSum / voiceBins) / (voice / voiceBins) : 1.0;
+        frame.centroid = voice > 0.0 ? weighted / voice : 0.0;
+        frame.x[3] = f > 0 && magSum > 0.0 ? flux / magSum : 0.0;
+    }
+
+    // Centroid motion: spread of the voice-band centroid around each frame.
+    for (int f = 0; f < frameCount; ++f) {
+        const int a = std::max(0, f - kMotionRadius);
+        const int b = std::min(frameCount - 1, f + kMotionRadius);
+        double mean = 0.0;
+        for (int i = a; i <= b; ++i) {
+            mean += frames[i].centroid;
+        }
+        mean /= (b - a + 1);
+        double var = 0.0;
+        for (int i = a; i <= b; ++i) {
+            var += (frames[i].centroid - mean) * (frames[i].centroid - mean);
+        }
+        frames[f].x[2] = std::sqrt(var / (b - a + 1));
+    }
+
+    QVector<float> probability(frameCount, -1.0f);
+    for (int f = 0; f < frameCount; ++f) {
+        if (frames[f].energyDb < loudestDb + kSilenceDb) {
+            continue;
+        }
+        double z = kBias;
+        for (int i = 0; i < kFeatureCount; ++i) {
+            z += kWeights[i].weight * (frames[f].x[i] - kWeights[i].mean) / kWeights[i].scale;
+        }
+        probability[f] = static_cast<float>(logistic(z));
+    }
+
+    // A sung phrase lasts seconds; averaging over ~1 s keeps single
+    // percussive or plucked frames from counting as vocals.
+    int audible = 0;
+    int vocal = 0;
+    for (int f = 0; f < frameCount; ++f) {
+        if (probability[f] < 0.0f) {
+            continue;
+        }
+        double sum = 0.0;
+        int count = 0;
+        for (int i = std::max(0, f - kSmoothRadius); i <= std::min(frameCount - 1, f + kSmoothRadius); ++i) {
+            if (probability[i] >= 0.0f) {
+                sum += probability[i];
+                ++count;
+            }
+        }
+        ++audible;
+        if (sum / count > 0.5) {
+            ++vocal;
+        }
+    }
+    if (audible < kMinAudibleFrames) {
+        return out;
+    }
+
+    out.valid = true;
+    out.vocalFraction = static_cast<double>(vocal) / audible;
+    out.instrumental = out.vocalFraction < kVocalFractionThreshold;
+    const double margin = out.instrumental
+                              ? (kVocalFractionThreshold - out.vocalFraction) / kVocalFractionThreshold
+                              : (out.vocalFraction - kVocalFractionThreshold) / (0.5 - kVocalFractionThreshold);
+    // Short clips say less about a whole track.
+    const double coverage = std::min(1.0, audible / (30.0 * sampleRate / kHopSize));
+    out.confidence = std::clamp(margin, 0.0, 1.0) * (0.5 + 0.5 * coverage);
+    return out;
+}
+
+bool detectVocals(const QString &audioPath, VocalEstimate *estimate, QString *error) {
+    AudioDecodeOptions options;
+    options.sampleRate = kAnalysisSampleRate;
+    options.channelCount = 1;
+    options.maxDurationMs = kMaxAnalysisMs;
+    QVector<float> mono;
+    AudioStreamInfo info;
+    if (!decodeAudioFile(audioPath, options, &mono, &info, error)) {
+        return false;
+    }
+    *estimate = estimateVocals(mono, info.sampleRate);
+    if (!estimate->valid) {
+        if (error) {
+            *error = QStringLiteral("Too little audible audio");
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct VocalEstimate {
+    bool valid = false;
+    bool instrumental = false;
+    // Share of the audible frames the classifier marked as sung or spoken.
+    double vocalFraction = 0.0;
+    double confidence = 0.0;
+};
+
+VocalEstimate estimateVocals(const QVector<float> &mono, int sampleRate);
+bool detectVocals(const QString &audioPath, VocalEstimate *estimate, QString *error = nullptr);
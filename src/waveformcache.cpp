@@ -0,0 +1,246 @@
+#include "waveformcache.h"
+
+#include "audiodecode.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+constexpr quint32 kPeakFileMagic = 0x57465031;
+constexpr int kPeakSampleRate = 8000;
+constexpr int kRawHop = 64;
+constexpr int kBaseBuckets = 2048;
+constexpr int kMinBuckets = 64;
+constexpr int kMemoryBudgetBytes = 24 * 1024 * 1024;
+constexpr qint64 kRecheckMs = 2000;
+
+qint8 quantize(float value) {
+    return static_cast<qint8>(qBound(-127, qRound(value * 127.0f), 127));
+}
+
+bool readPeakFile(const QString &fileName, WaveformPeaks *peaks) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    in >> magic;
+    if (magic != kPeakFileMagic) {
+        return false;
+    }
+    in >> peaks->durationMs >> peaks->levels;
+    return in.status() == QDataStream::Ok && !peaks->levels.isEmpty();
+}
+
+void writePeakFile(const QString &fileName, const WaveformPeaks &peaks) {
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << kPeakFileMagic << peaks.durationMs << peaks.levels;
+    file.commit();
+}
+
+bool generatePeaks(const QString &audioPath, WaveformPeaks *peaks) {
+    QVector<float> rawMin;
+    QVector<float> rawMax;
+    float curMin = 0.0f;
+    float curMax = 0.0f;
+    int inHop = 0;
+    qint64 frames = 0;
+
+    AudioDecodeOptions options;
+    options.sampleRate = kPeakSampleRate;
+    options.channelCount = 1;
+    const bool ok = decodeAudioStream(
+        audioPath, options, [&](const float *samples, qsizetype count, const AudioStreamInfo &) {
+            for (qsizetype i = 0; i < count; ++i) {
+                const float s = samples[i];
+                if (inHop == 0) {
+                    curMin = s;
+                    curMax = s;
+                } else {
+                    curMin = std::min(curMin, s);
+                    curMax = std::max(curMax, s);
+                }
+                if (++inHop == kRawHop) {
+                    rawMin.append(curMin);
+                    rawMax.append(curMax);
+                    inHop = 0;
+                }
+            }
+            frames += count;
+            return true;
+        });
+    if (inHop > 0) {
+        rawMin.append(curMin);
+        rawMax.append(curMax);
+    }
+    if (!ok || rawMin.isEmpty()) {
+        return false;
+    }
+
+    const int rawCount = rawMin.size();
+    const int baseCount = std::min(kBaseBuckets, rawCount);
+    QVector<qint8> base(baseCount * 2);
+    for (int b = 0; b < baseCount; ++b) {
+        const int from = static_cast<int>(static_cast<qint64>(b) * rawCount / baseCount);
+        const int to = std::max(from + 1, static_cast<int>(static_cast<qint64>(b + 1) * rawCount / baseCount));
+        float lo = rawMin[from];
+        float hi = rawMax[from];
+        for (int r = from + 1; r < to; ++r) {
+            lo = std::min(lo, rawMin[r]);
+            hi = std::max(hi, rawMax[r]);
+        }
+        base[b * 2] = quantize(lo);
+        base[b * 2 + 1] = quantize(hi);
+    }
+
+    peaks->durationMs = frames * 1000 / kPeakSampleRate;
+    peaks->levels = {base};
+    while (peaks->levels.last().size() / 2 >= kMinBuckets * 2) {
+        const QVector<qint8> &prev = peaks->levels.last();
+        const int count = prev.size() / 4;
+        QVector<qint8> next(count * 2);
+        for (int b = 0; b < count; ++b) {
+            next[b * 2] = std::min(prev[b * 4], prev[b * 4 + 2]);
+            next[b * 2 + 1] = std::max(prev[b * 4 + 1], prev[b * 4 + 3]);
+        }
+        peaks->levels.append(next);
+    }
+    return true;
+}
+}
+
+int WaveformPeaks::levelForWidth(int pixels) const {
+    for (int level = levels.size() - 1; level > 0; --level) {
+        if (bucketCount(level) >= pixels) {
+            return level;
+        }
+    }
+    return 0;
+}
+
+int WaveformPeaks::byteSize() const {
+    int bytes = 0;
+    for (const QVector<qint8> &level : levels) {
+        bytes += level.size();
+    }
+    return bytes;
+}
+
+WaveformCache *WaveformCache::instance() {
+    static QPointer<WaveformCache> cache;
+    if (!cache) {
+        cache = new WaveformCache(qApp);
+    }
+    return cache;
+}
+
+WaveformCache::WaveformCache(QObject *parent) : QObject(parent) {
+    m_memory.setMaxCost(kMemoryBudgetBytes);
+    m_clock.start();
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        m_pool.clear();
+        m_pool.waitForDone();
+    });
+}
+
+const WaveformPeaks *WaveformCache::peaks(const QString &audioPath, QWidget *requester) {
+    if (audioPath.isEmpty()) {
+        return nullptr;
+    }
+    if (Entry *cached = m_memory.object(audioPath)) {
+        if (isCurrent(audioPath, *cached)) {
+            return &cached->peaks;
+        }
+        m_memory.remove(audioPath);
+    }
+    const auto failed = m_failed.find(audioPath);
+    if (failed != m_failed.end()) {
+        if (isCurrent(audioPath, *failed)) {
+            return nullptr;
+        }
+        m_failed.erase(failed);
+    }
+
+    auto waiters = m_waiters.find(audioPath);
+    const bool queued = waiters != m_waiters.end();
+    if (!queued) {
+        waiters = m_waiters.insert(audioPath, {});
+    }
+    if (requester && !waiters.value().contains(requester)) {
+        waiters.value().append(requester);
+    }
+    if (queued) {
+        return nullptr;
+    }
+
+    // Later requests come from whatever is on screen now, so they run first.
+    m_pool.start(
+        [this, audioPath]() {
+            // Taken first, so a file replaced during the decode is noticed.
+            const AudioFileStamp stamp = audioFileStamp(audioPath);
+            WaveformPeaks result;
+            const QString cacheFile = audioCacheFilePath(QStringLiteral("waveforms"), audioPath,
+                                                         QStringLiteral(".peaks"));
+            if (!readPeakFile(cacheFile, &result)) {
+                result = WaveformPeaks();
+                if (generatePeaks(audioPath, &result)) {
+                    writePeakFile(cacheFile, result);
+                }
+            }
+            QMetaObject::invokeMethod(
+                this, [this, audioPath, result, stamp]() { finishJob(audioPath, result, stamp); },
+                Qt::QueuedConnection);
+        },
+        ++m_requestSerial);
+    return nullptr;
+}
+
+qint64 WaveformCache::cachedDurationMs(const QString &audioPath) {
+    QFile file(audioCacheLookupPath(QStringLiteral("waveforms"), audioPath, QStringLiteral(".peaks")));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint64 durationMs = -1;
+    in >> magic >> durationMs;
+    return in.status() == QDataStream::Ok && magic == kPeakFileMagic && durationMs > 0 ? durationMs : -1;
+}
+
+void WaveformCache::retry(const QString &audioPath) {
+    m_memory.remove(audioPath);
+    m_failed.remove(audioPath);
+}
+
+bool WaveformCache::isCurrent(const QString &audioPath, Entry &entry) {
+    const qint64 now = m_clock.elapsed();
+    if (now - entry.checkedMs < kRecheckMs) {
+        return true;
+    }
+    entry.checkedMs = now;
+    return audioFileStamp(audioPath) == entry.stamp;
+}
+
+void WaveformCache::finishJob(const QString &audioPath, const WaveformPeaks &peaks, const AudioFileStamp &stamp) {
+    const QList<QPointer<QWidget>> waiters = m_waiters.take(audioPath);
+    if (peaks.levels.isEmpty()) {
+        m_failed.insert(audioPath, {WaveformPeaks(), stamp, m_clock.elapsed()});
+        return;
+    }
+    m_memory.insert(audioPath, new Entry{peaks, stamp, m_clock.elapsed()}, std::max(1, peaks.byteSize()));
+    for (const QPointer<QWidget> &widget : waiters) {
+        if (widget) {
+            widget->update();
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "audiodecode.h"
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QWidget>
+
+struct WaveformPeaks {
+    // Level 0 has the most buckets; each following level halves the count.
+    // Every level stores interleaved min/max pairs scaled to [-127, 127].
+    QVector<QVector<qint8>> levels;
+    qint64 durationMs = 0;
+
+    int bucketCount(int level) const { return levels.value(level).size() / 2; }
+    int levelForWidth(int pixels) const;
+    int byteSize() const;
+};
+
+class WaveformCache : public QObject {
+    Q_OBJECT
+
+public:
+    static WaveformCache *instance();
+
+    // Returns nullptr until peaks are in memory; the pointer stays valid until
+    // control returns to the event loop. The requester is repainted once the
+    // peaks arrive from the disk cache or a background decode.
+    const WaveformPeaks *peaks(const QString &audioPath, QWidget *requester);
+    // The length stored with the peaks on disk, or -1 when the file has no
+    // cached peaks. Safe to call from any thread.
+    static qint64 cachedDurationMs(const QString &audioPath);
+    // Forgets the peaks or decode failure held for the file, so the next
+    // request reads it again.
+    void retry(const QString &audioPath);
+
+private:
+    explicit WaveformCache(QObject *parent = nullptr);
+
+    // Peaks, or a failure when they are empty, with the stamp of the file
+    // they were read from. A file whose stamp has changed is read again.
+    struct Entry {
+        WaveformPeaks peaks;
+        AudioFileStamp stamp;
+        qint64 checkedMs = 0;
+    };
+
+    void finishJob(const QString &audioPath, const WaveformPeaks &peaks, const AudioFileStamp &stamp);
+    // Stats the file at most once per recheck interval, since it is asked
+    // on every paint.
+    bool isCurrent(const QString &audioPath, Entry &entry);
+
+    QCache<QString, Entry> m_memory;
+    QHash<QString, QList<QPointer<QWidget>>> m_waiters;
+    QHash<QString, Entry> m_failed;
+    QElapsedTimer m_clock;
+    QThreadPool m_pool;
+    int m_requestSerial = 0;
+};
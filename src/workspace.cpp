@@ -0,0 +1,199 @@
+#include "workspace.h"
+
+#include "datasetio.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace {
+void stampSource(DatasetSummary &summary) {
+    const QFileInfo fi(summary.sourcePath);
+    summary.sourceSize = fi.isDir() ? 0 : fi.size();
+    summary.sourceModifiedMs = fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+QJsonObject summaryToJson(const DatasetSummary &summary) {
+    QJsonObject o;
+    o.insert("path", summary.path);
+    o.insert("name", summary.name);
+    o.insert("tracks", summary.tracks);
+    o.insert("captioned", summary.captioned);
+    o.insert("with_lyrics", summary.withLyrics);
+    o.insert("total_seconds", summary.totalSeconds);
+    o.insert("source_path", summary.sourcePath);
+    o.insert("source_size", summary.sourceSize);
+    o.insert("source_modified", summary.sourceModifiedMs);
+    if (!summary.error.isEmpty()) {
+        o.insert("error", summary.error);
+    }
+    return o;
+}
+
+DatasetSummary summaryFromJson(const QJsonObject &o) {
+    DatasetSummary summary;
+    summary.path = o.value("path").toString();
+    summary.name = o.value("name").toString(QFileInfo(summary.path).completeBaseName());
+    summary.tracks = o.value("tracks").toInt();
+    summary.captioned = o.value("captioned").toInt();
+    summary.withLyrics = o.value("with_lyrics").toInt();
+    summary.totalSeconds = static_cast<qint64>(o.value("total_seconds").toDouble());
+    summary.sourcePath = o.value("source_path").toString();
+    summary.sourceSize = static_cast<qint64>(o.value("source_size").toDouble(-1));
+    summary.sourceModifiedMs = static_cast<qint64>(o.value("source_modified").toDouble(-1));
+    summary.error = o.value("error").toString();
+    return summary;
+}
+}
+
+QString datasetSourcePath(const QString &path) {
+    const QFileInfo fi(path);
+    if (!fi.isDir()) {
+        return fi.absoluteFilePath();
+    }
+    const QFileInfoList jsonFiles =
+        QDir(path).entryInfoList({"*.json", "*.jsonl"}, QDir::Files | QDir::Readable, QDir::Name);
+    return jsonFiles.isEmpty() ? fi.absoluteFilePath() : jsonFiles.first().absoluteFilePath();
+}
+
+DatasetSummary summarizeDataset(const QString &path) {
+    DatasetSummary summary;
+    summary.path = path;
+    summary.name = QFileInfo(path).completeBaseName();
+    summary.sourcePath = datasetSourcePath(path);
+    stampSource(summary);
+    if (!QFileInfo::exists(path)) {
+        summary.error = QStringLiteral("Not found");
+        return summary;
+    }
+    if (QFileInfo(summary.sourcePath).isDir()) {
+        summary.tracks = static_cast<int>(QDir(path).entryList(audioFileFilters(), QDir::Files).size());
+        return summary;
+    }
+
+    DatasetMetadata meta;
+    const bool ok = readDatasetSamples(
+        summary.sourcePath, QFileInfo(summary.sourcePath).absolutePath(), &meta,
+        [&summary](const TrackData &track) {
+            ++summary.tracks;
+            if (!track.caption.trimmed().isEmpty()) {
+                ++summary.captioned;
+            }
+            if (!track.lyrics.trimmed().isEmpty()) {
+                ++summary.withLyrics;
+            }
+            summary.totalSeconds += qMax(0, track.duration);
+            return true;
+        },
+        &summary.error);
+    if (!ok) {
+        summary.tracks = summary.captioned = summary.withLyrics = 0;
+        summary.totalSeconds = 0;
+        return summary;
+    }
+    summary.name = meta.name;
+    return summary;
+}
+
+bool isSummaryCurrent(const DatasetSummary &summary) {
+    if (summary.sourcePath != datasetSourcePath(summary.path)) {
+        return false;
+    }
+    DatasetSummary now = summary;
+    stampSource(now);
+    return now.sourceSize == summary.sourceSize && now.sourceModifiedMs == summary.sourceModifiedMs;
+}
+
+DatasetSummary refreshSummary(const DatasetSummary &cached) {
+    return isSummaryCurrent(cached) ? cached : summarizeDataset(cached.path);
+}
+
+WorkspaceIndex::WorkspaceIndex(const QString &indexPath)
+    : m_indexPath(indexPath) {}
+
+bool WorkspaceIndex::load(QString *error) {
+    m_entries.clear();
+    QFile f(m_indexPath);
+    if (!f.exists()) {
+        return true;
+    }
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = f.errorString();
+        }
+        return false;
+    }
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (error) {
+            *error = err.error != QJsonParseError::NoError ? err.errorString()
+                                                            : QStringLiteral("Not a workspace index");
+        }
+        return false;
+    }
+    const QJsonArray datasets = doc.object().value("datasets").toArray();
+    for (const QJsonValue &v : datasets) {
+        const DatasetSummary summary = summaryFromJson(v.toObject());
+        if (!summary.path.isEmpty() && indexOf(summary.path) < 0) {
+            m_entries.append(summary);
+        }
+    }
+    return true;
+}
+
+bool WorkspaceIndex::save(QString *error) const {
+    QJsonArray datasets;
+    for (const DatasetSummary &summary : m_entries) {
+        datasets.append(summaryToJson(summary));
+    }
+    QJsonObject root;
+    root.insert("datasets", datasets);
+    const QByteArray bytes = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    QSaveFile file(m_indexPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+int WorkspaceIndex::indexOf(const QString &path) const {
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].path == path) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool WorkspaceIndex::add(const QString &path) {
+    if (indexOf(path) >= 0) {
+        return false;
+    }
+    DatasetSummary summary;
+    summary.path = path;
+    summary.name = QFileInfo(path).completeBaseName();
+    m_entries.append(summary);
+    return true;
+}
+
+void WorkspaceIndex::remove(const QString &path) {
+    const int i = indexOf(path);
+    if (i >= 0) {
+        m_entries.removeAt(i);
+    }
+}
+
+void WorkspaceIndex::update(const DatasetSummary &summary) {
+    const int i = indexOf(summary.path);
+    if (i >= 0) {
+        m_entries[i] = summary;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+// What the workspace panel shows for a dataset without opening it.
+struct DatasetSummary {
+    // A dataset folder or a .json / .jsonl file.
+    QString path;
+    QString name;
+    int tracks = 0;
+    int captioned = 0;
+    int withLyrics = 0;
+    qint64 totalSeconds = 0;
+    // The file the counts were read from and its size and modification time
+    // then; a summary is stale once they no longer match.
+    QString sourcePath;
+    qint64 sourceSize = -1;
+    qint64 sourceModifiedMs = -1;
+    // Empty when the counts are valid.
+    QString error;
+};
+
+// The file a dataset path is read from: the path itself, or for a folder
+// the .json that opening the folder would load, or the folder when it only
+// holds audio files.
+QString datasetSourcePath(const QString &path);
+// Streams the samples without building tracks or cards.
+DatasetSummary summarizeDataset(const QString &path);
+bool isSummaryCurrent(const DatasetSummary &summary);
+// Returns cached while it is still current, otherwise a new summary.
+DatasetSummary refreshSummary(const DatasetSummary &cached);
+
+// The datasets in the workspace with their last summaries, kept in a small
+// JSON index so the panel fills without reading any dataset.
+class WorkspaceIndex {
+public:
+    explicit WorkspaceIndex(const QString &indexPath);
+
+    bool load(QString *error = nullptr);
+    bool save(QString *error = nullptr) const;
+
+    const QList<DatasetSummary> &entries() const { return m_entries; }
+    int indexOf(const QString &path) const;
+    // Returns false when the path is already listed.
+    bool add(const QString &path);
+    void remove(const QString &path);
+    // Replaces the entry with the same path, if it is still listed.
+    void update(const DatasetSummary &summary);
+
+private:
+    QString m_indexPath;
+    QList<DatasetSummary> m_entries;
+};